@@ -0,0 +1,354 @@
+#include <atomic>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <html_generator/generate.hpp>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <silicium/sink/iterator_sink.hpp>
+
+// Microbenchmarks for the code that turns the blog into HTML. Every benchmark
+// reports the throughput in MB of input per second and the number of heap
+// allocations per KB of input. Only Release builds give meaningful numbers.
+//
+// usage: benchmarks [name filter] [post count] [post size in KB]
+
+namespace
+{
+	std::atomic<std::size_t> allocation_count(0);
+}
+
+void *operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void *const memory = std::malloc(size ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+namespace
+{
+	std::chrono::milliseconds const minimum_duration(500);
+
+	// Calls run repeatedly for at least minimum_duration. run returns the
+	// number of input bytes it processed.
+	template <class Run>
+	void measure(char const *name, char const *filter, Run &&run)
+	{
+		if (filter && !std::strstr(name, filter))
+		{
+			return;
+		}
+
+		// the first run warms up caches and lazily initialized statics
+		run();
+
+		using clock = std::chrono::steady_clock;
+		std::size_t const allocations_before = allocation_count.load();
+		std::size_t processed_bytes = 0;
+		std::size_t iterations = 0;
+		clock::time_point const start = clock::now();
+		clock::duration elapsed;
+		do
+		{
+			processed_bytes += run();
+			++iterations;
+			elapsed = clock::now() - start;
+		} while (elapsed < minimum_duration);
+		std::size_t const allocations =
+		    allocation_count.load() - allocations_before;
+
+		double const seconds =
+		    std::chrono::duration<double>(elapsed).count();
+		double const megabytes =
+		    static_cast<double>(processed_bytes) / (1024.0 * 1024.0);
+		double const kilobytes =
+		    static_cast<double>(processed_bytes) / 1024.0;
+		std::cout << std::left << std::setw(20) << name << std::right
+		          << std::fixed << std::setprecision(2) << std::setw(10)
+		          << (megabytes / seconds) << " MB/s" << std::setw(12)
+		          << (static_cast<double>(allocations) / kilobytes)
+		          << " allocs/KB" << std::setw(10) << iterations
+		          << " iterations\n";
+	}
+
+	// C++ that contains every kind of token the highlighter knows about.
+	std::string make_synthetic_code(std::size_t const minimum_size)
+	{
+		static char const part[] =
+		    "#include <cstdint>\n"
+		    "\n"
+		    "// converts a value for the wire protocol\n"
+		    "namespace example\n"
+		    "{\n"
+		    "    /* the result is always\n"
+		    "       big endian */\n"
+		    "    template <class Integer>\n"
+		    "    std::uint32_t to_wire(Integer const &value, char const "
+		    "*name = \"a \\\"quoted\\\" name\")\n"
+		    "    {\n"
+		    "        static_assert(sizeof(Integer) <= 4, \"too large\");\n"
+		    "        if (value < 0 && name[0] != '\\0')\n"
+		    "        {\n"
+		    "            throw std::invalid_argument(name);\n"
+		    "        }\n"
+		    "        return static_cast<std::uint32_t>(value) + 'c';\n"
+		    "    }\n"
+		    "}\n"
+		    "\n";
+		std::string code;
+		while (code.size() < minimum_size)
+		{
+			code += part;
+		}
+		return code;
+	}
+
+	// bark_down paragraphs with some inline code
+	std::string make_synthetic_markdown(std::size_t const minimum_size)
+	{
+		static char const part[] =
+		    "Prefer portable types like `std::uint32_t` over the types "
+		    "without an\nexplicit range. Use `int`, `long`, `long long` only "
+		    "if you have a\nreason to use exactly these & not the portable "
+		    "ones <like this>.\n"
+		    "\n";
+		std::string markdown;
+		while (markdown.size() < minimum_size)
+		{
+			markdown += part;
+		}
+		return markdown;
+	}
+
+	// a post with the front matter, paragraphs, tables and a snippet
+	std::string make_synthetic_post(std::size_t const number,
+	                                std::size_t const minimum_size)
+	{
+		static char const table[] =
+		    "| Type | Range | Purpose |\n"
+		    "|------|-------|---------|\n"
+		    "| `std::uint8_t` | 0 to 255 | bytes & small counters |\n"
+		    "| `std::int64_t` | -2^63 to 2^63-1 | timestamps <in ms> |\n"
+		    "| `std::size_t` | platform | sizes of objects |\n"
+		    "\n";
+		std::string post = "---\ntitle: Synthetic post " +
+		                   boost::lexical_cast<std::string>(number) +
+		                   "\n---\n";
+		std::string const paragraphs = make_synthetic_markdown(
+		    (minimum_size > post.size()) ? (minimum_size - post.size()) : 0);
+		// the tables and the snippet are spread over the text
+		std::size_t const half = paragraphs.find("\n\n", paragraphs.size() / 2);
+		std::size_t const split =
+		    (half == std::string::npos) ? paragraphs.size() : (half + 2);
+		post.append(paragraphs, 0, split);
+		post += table;
+		post += "@snippet synthetic.cpp\n\n";
+		post += table;
+		post.append(paragraphs, split, std::string::npos);
+		return post;
+	}
+
+	void write_file(boost::filesystem::path const &file,
+	                std::string const &content)
+	{
+		boost::filesystem::ofstream out(file, std::ios::binary);
+		out << content;
+	}
+
+	// The input of generate_all_html: post_count posts of about post_size
+	// bytes each, and the snippet that every one of them shows. Returns the
+	// number of input bytes that one generation processes.
+	std::size_t write_synthetic_blog(boost::filesystem::path const &root,
+	                                 std::size_t const post_count,
+	                                 std::size_t const post_size)
+	{
+		boost::filesystem::create_directories(root / "snippets");
+		boost::filesystem::create_directories(root / "posts");
+		std::string const snippet = make_synthetic_code(post_size / 4);
+		write_file(root / "snippets" / "synthetic.cpp", snippet);
+		std::size_t input_size = 0;
+		for (std::size_t i = 0; i < post_count; ++i)
+		{
+			std::string const post = make_synthetic_post(i, post_size);
+			// the names sort like the numbers
+			std::string number = boost::lexical_cast<std::string>(i);
+			number.insert(0, 6 - (std::min)(number.size(), std::size_t(6)),
+			              '0');
+			write_file(root / "posts" / (number + ".md"), post);
+			input_size += post.size() + snippet.size();
+		}
+		return input_size;
+	}
+
+	std::size_t const synthetic_input_size = 256 * 1024;
+
+	// Generated HTML is appended to a string that keeps its capacity between
+	// the runs so that the growth of the output does not distort the
+	// allocation counts.
+	struct html_output
+	{
+		std::string html;
+
+		template <class Element>
+		void generate(Element &&element)
+		{
+			html.clear();
+			auto sink = Si::Sink<char, Si::success>::erase(
+			    Si::make_container_sink(html));
+			std::forward<Element>(element).generate(sink);
+		}
+	};
+}
+
+int main(int argc, char **argv)
+{
+	char const *const filter = (argc >= 2) ? argv[1] : nullptr;
+	std::size_t const post_count =
+	    (argc >= 3) ? boost::lexical_cast<std::size_t>(argv[2]) : 100;
+	std::size_t const post_size =
+	    ((argc >= 4) ? boost::lexical_cast<std::size_t>(argv[3]) : 16) * 1024;
+
+	std::string const code = make_synthetic_code(synthetic_input_size);
+	std::string const markdown = make_synthetic_markdown(synthetic_input_size);
+	html_output output;
+
+	measure("find_next_token", filter, [&code]()
+	        {
+		        auto i = code.begin();
+		        for (;;)
+		        {
+			        token const t = find_next_token(i, code.end());
+			        if (t.type == token_type::eof)
+			        {
+				        break;
+			        }
+			        i += t.content.size();
+		        }
+		        return code.size();
+		    });
+
+	std::vector<boost::string_ref> identifiers;
+	for (auto i = code.begin();;)
+	{
+		token const t = find_next_token(i, code.end());
+		if (t.type == token_type::eof)
+		{
+			break;
+		}
+		i += t.content.size();
+		if (t.type == token_type::identifier)
+		{
+			identifiers.emplace_back(t.content);
+		}
+	}
+	measure("is_keyword", filter, [&identifiers]()
+	        {
+		        std::size_t processed = 0;
+		        std::size_t keywords = 0;
+		        for (boost::string_ref const identifier : identifiers)
+		        {
+			        keywords += is_keyword(identifier);
+			        processed += identifier.size();
+		        }
+		        // prevents the compiler from optimizing the loop away
+		        if (keywords == identifiers.size() + 1)
+		        {
+			        std::cout << '\n';
+		        }
+		        return processed;
+		    });
+
+	measure("render_code_raw", filter, [&code, &output]()
+	        {
+		        output.generate(render_code_raw(code));
+		        return code.size();
+		    });
+
+	measure("make_code_snippet", filter, [&code, &output]()
+	        {
+		        output.generate(make_code_snippet(code));
+		        return code.size();
+		    });
+
+	measure("write_escaped_text", filter, [&markdown, &output]()
+	        {
+		        output.html.clear();
+		        auto sink = Si::Sink<char, Si::success>::erase(
+		            Si::make_container_sink(output.html));
+		        write_escaped_text(sink, markdown);
+		        return markdown.size();
+		    });
+
+	measure("compile", filter, [&markdown, &output]()
+	        {
+		        output.generate(compile(markdown));
+		        return markdown.size();
+		    });
+
+	boost::filesystem::path const temporary =
+	    boost::filesystem::temp_directory_path() /
+	    boost::filesystem::unique_path();
+	int result = 0;
+	if (!filter || std::strstr("generate_all_html", filter))
+	{
+		// The posts of the blog are too few and too small to show anything
+		// but the fixed costs of a generation.
+		std::size_t const input_size =
+		    write_synthetic_blog(temporary, post_count, post_size);
+		boost::filesystem::create_directories(temporary / "output");
+		ventura::absolute_path const root =
+		    *ventura::absolute_path::create(temporary);
+		ventura::absolute_path const output_root =
+		    root / ventura::relative_path("output");
+		measure("generate_all_html", filter,
+		        [&root, &output_root, input_size, &result]()
+		        {
+			        boost::system::error_code const ec = generate_all_html(
+			            root / ventura::relative_path("snippets"),
+			            root / ventura::relative_path("posts"), output_root,
+			            "index.html");
+			        if (!!ec)
+			        {
+				        std::cerr << ec << '\n';
+				        result = 1;
+				        return std::size_t(0);
+			        }
+			        return input_size;
+			    });
+	}
+	boost::system::error_code ignored;
+	boost::filesystem::remove_all(temporary, ignored);
+	return result;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/system/error_code.hpp>
+#include <silicium/sink/file_sink.hpp>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/uio.h>
+#endif
+
+// A page is generated as thousands of small pieces of text. Writing each of
+// them to the file separately would cost one system call per piece, so they
+// are collected in a buffer instead. When the buffer is full, it is written
+// together with the piece that did not fit into it with a single writev.
+class buffered_file_sink
+{
+public:
+	typedef char element_type;
+	typedef boost::system::error_code error_type;
+
+	explicit buffered_file_sink(Si::native_file_descriptor const file,
+	                            std::size_t const buffer_size = 64 * 1024)
+	    : m_file(file)
+	    , m_write_calls(0)
+	    , m_written_bytes(0)
+	{
+		m_buffer.reserve(buffer_size);
+	}
+
+	error_type append(Si::iterator_range<char const *> const data)
+	{
+		std::size_t const size = static_cast<std::size_t>(data.size());
+		if (size <= (m_buffer.capacity() - m_buffer.size()))
+		{
+			m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+			return {};
+		}
+		error_type const ec = write_all(data.begin(), size);
+		m_buffer.clear();
+		return ec;
+	}
+
+	// Has to be called after the last append because the destructor cannot
+	// report errors.
+	error_type flush()
+	{
+		error_type const ec = write_all(nullptr, 0);
+		m_buffer.clear();
+		return ec;
+	}
+
+	// the number of system calls that wrote to the file so far
+	std::size_t write_calls() const
+	{
+		return m_write_calls;
+	}
+
+	std::size_t written_bytes() const
+	{
+		return m_written_bytes;
+	}
+
+private:
+	Si::native_file_descriptor m_file;
+	std::vector<char> m_buffer;
+	std::size_t m_write_calls;
+	std::size_t m_written_bytes;
+
+	// Writes the buffer followed by [extra, extra + extra_size).
+	error_type write_all(char const *extra, std::size_t extra_size)
+	{
+		char const *buffered = m_buffer.data();
+		std::size_t buffered_size = m_buffer.size();
+		while ((buffered_size + extra_size) > 0)
+		{
+			std::size_t written = 0;
+#ifdef _WIN32
+			char const *const piece = (buffered_size > 0) ? buffered : extra;
+			DWORD const piece_size = static_cast<DWORD>(
+			    (buffered_size > 0) ? buffered_size : extra_size);
+			DWORD written_now = 0;
+			if (!WriteFile(m_file, piece, piece_size, &written_now, nullptr))
+			{
+				return error_type(static_cast<int>(GetLastError()),
+				                  boost::system::system_category());
+			}
+			written = written_now;
+#else
+			iovec pieces[2];
+			int piece_count = 0;
+			if (buffered_size > 0)
+			{
+				pieces[piece_count].iov_base = const_cast<char *>(buffered);
+				pieces[piece_count].iov_len = buffered_size;
+				++piece_count;
+			}
+			if (extra_size > 0)
+			{
+				pieces[piece_count].iov_base = const_cast<char *>(extra);
+				pieces[piece_count].iov_len = extra_size;
+				++piece_count;
+			}
+			ssize_t const result = ::writev(m_file, pieces, piece_count);
+			if (result < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return error_type(errno, boost::system::system_category());
+			}
+			written = static_cast<std::size_t>(result);
+#endif
+			++m_write_calls;
+			m_written_bytes += written;
+
+			// a write may be partial
+			std::size_t const from_buffer = (std::min)(written, buffered_size);
+			buffered += from_buffer;
+			buffered_size -= from_buffer;
+			extra += (written - from_buffer);
+			extra_size -= (written - from_buffer);
+		}
+		return {};
+	}
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+#include <cstdint>
+#include <string>
+
+// A 64-bit FNV-1a hash that can be fed in pieces. It is used to recognize
+// content that has not changed, not to protect against anyone, so speed and
+// simplicity matter more than collision resistance.
+struct content_hash
+{
+	std::uint64_t state = 14695981039346656037ULL;
+
+	void add(boost::string_ref const content)
+	{
+		for (char const c : content)
+		{
+			state ^= static_cast<unsigned char>(c);
+			state *= 1099511628211ULL;
+		}
+	}
+
+	// Adds the size before the content so that the pieces "ab", "c" do not
+	// hash the same as "a", "bc".
+	void add_delimited(boost::string_ref const content)
+	{
+		std::uint64_t size = content.size();
+		char size_bytes[8];
+		for (char &byte : size_bytes)
+		{
+			byte = static_cast<char>(size & 0xffu);
+			size >>= 8u;
+		}
+		add(boost::string_ref(size_bytes, sizeof(size_bytes)));
+		add(content);
+	}
+
+	// 16 lower case hexadecimal digits
+	std::string to_hex() const
+	{
+		static char const digits[] = "0123456789abcdef";
+		std::string result(16, '0');
+		std::uint64_t remaining = state;
+		for (std::size_t i = 0; i < 16; ++i)
+		{
+			result[15 - i] = digits[remaining & 0xfu];
+			remaining >>= 4u;
+		}
+		return result;
+	}
+};
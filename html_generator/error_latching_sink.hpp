@@ -0,0 +1,34 @@
+#pragma once
+
+#include <boost/system/error_code.hpp>
+#include <silicium/sink/sink.hpp>
+
+// Si::html::code_sink cannot report errors. Instead of throwing them through
+// the HTML tree, the first error of the next sink is stored in first_error
+// and everything after it is dropped. The caller checks first_error once the
+// tree is generated.
+template <class Next>
+struct error_latching_sink
+{
+	typedef typename Next::element_type element_type;
+	typedef Si::success error_type;
+
+	Next *next;
+	boost::system::error_code *first_error;
+
+	error_type append(Si::iterator_range<element_type const *> const data)
+	{
+		if (!*first_error)
+		{
+			*first_error = next->append(data);
+		}
+		return {};
+	}
+};
+
+template <class Next>
+error_latching_sink<Next>
+make_error_latching_sink(Next &next, boost::system::error_code &first_error)
+{
+	return error_latching_sink<Next>{&next, &first_error};
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <html_generator/buffered_file_sink.hpp>
+#include <html_generator/error_latching_sink.hpp>
+#include <html_generator/posts.hpp>
+#include <html_generator/replace_file.hpp>
+#include <html_generator/tools/all.hpp>
+#include <ventura/file_operations.hpp>
+
+static char const site_title[] = "TyRoXx' blog";
+
+inline auto make_page_head()
+{
+	using namespace Si::html;
+	return tags::head(
+	    tag("meta", attribute("charset", "utf-8"), empty) +
+	    tag("meta",
+	        attribute("name", "viewport") +
+	            attribute("content", "width=device-width, initial-scale=1"),
+	        empty) +
+	    tags::title(site_title) +
+	    tag("link",
+	        tags::href("stylesheets.css") + attribute("rel", "stylesheet"),
+	        empty) +
+	    tag("link", tags::href("stylesheets-dark.css") +
+	                    attribute("rel", "stylesheet"),
+	        empty) +
+	    tag("script", attribute("src", "toggleTheme.js"), text(" ")));
+}
+
+inline auto make_page_header()
+{
+	using namespace Si::html;
+	return tags::h1(text(site_title)) +
+	       tags::a(tags::href("#") + attribute("onclick", "toggleTheme()"),
+	               text("Toggle theme"));
+}
+
+inline auto make_page_footer()
+{
+	using namespace Si::html;
+	return
+#include "pages/footer.hpp"
+	    + tag("script", text("setTheme();"));
+}
+
+// the keys of the prerendered parts of the page
+struct page_head_tag;
+struct page_header_tag;
+struct page_footer_tag;
+
+inline boost::system::error_code
+write_all_html(ventura::absolute_path snippets_source_code,
+               ventura::absolute_path posts_source,
+               ventura::absolute_path const &index_path,
+               snippet_cache const *const cache)
+{
+	Si::error_or<Si::file_handle> const index = ventura::overwrite_file(
+	    ventura::safe_c_str(to_os_string(index_path)));
+	if (index.is_error())
+	{
+		return index.error();
+	}
+
+	buffered_file_sink index_sink(index.get().handle);
+	using namespace Si::html;
+
+	auto page_content = dynamic([
+		snippets_source_code = std::move(snippets_source_code),
+		posts_source = std::move(posts_source),
+		cache
+	](code_sink & sink)
+	                            {
+		                            for (ventura::absolute_path const &file :
+		                                 find_posts(posts_source))
+		                            {
+			                            render_post(load_post(file),
+			                                        snippets_source_code,
+			                                        cache)
+			                                .generate(sink);
+		                            }
+		                        });
+
+	// Everything around the posts is the same on every generation.
+	auto head_content = tags::prerendered<page_head_tag>(make_page_head);
+	auto page_header = tags::prerendered<page_header_tag>(make_page_header);
+	auto page_footer = tags::prerendered<page_footer_tag>(make_page_footer);
+	auto body_content =
+	    tags::body(std::move(page_header) + std::move(page_content) +
+	               std::move(page_footer));
+	auto const document =
+	    raw("<!DOCTYPE html>") +
+	    tags::html(std::move(head_content) + std::move(body_content));
+	boost::system::error_code write_error;
+	auto erased_sink = Si::Sink<char, Si::success>::erase(
+	    make_error_latching_sink(index_sink, write_error));
+	document.generate(erased_sink);
+	if (!!write_error)
+	{
+		return write_error;
+	}
+	return index_sink.flush();
+}
+
+// The page is written next to the previous version and only replaces it when
+// it is complete, so a running server never serves half of a page.
+inline boost::system::error_code
+generate_all_html(ventura::absolute_path snippets_source_code,
+                  ventura::absolute_path posts_source,
+                  ventura::absolute_path const &existing_output_root,
+                  boost::string_ref const file_name,
+                  snippet_cache const *const cache = nullptr)
+{
+	boost::filesystem::path const index_path =
+	    (existing_output_root /
+	     ventura::relative_path(file_name.begin(), file_name.end()))
+	        .to_boost_path();
+	// Loading a post or highlighting a snippet may also throw.
+	pending_replacement replacement(index_path);
+	boost::system::error_code const ec = write_all_html(
+	    std::move(snippets_source_code), std::move(posts_source),
+	    *ventura::absolute_path::create(temporary_path_for(index_path)),
+	    cache);
+	if (!!ec)
+	{
+		return ec;
+	}
+	return replacement.commit();
+}
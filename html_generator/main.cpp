@@ -1,260 +1,910 @@
+#include <array>
 #include <beast/core/streambuf.hpp>
+#include <beast/http/parser_v1.hpp>
 #include <beast/http/read.hpp>
 #include <beast/http/string_body.hpp>
-#include <beast/http/write.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/program_options.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cassert>
+#include <csignal>
 #include <iostream>
-#include <silicium/sink/file_sink.hpp>
-#include <silicium/sink/throwing_sink.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <ventura/file_operations.hpp>
 #include <ventura/read_file.hpp>
-#include <html_generator/tools/all.hpp>
+#include <html_generator/generate.hpp>
+#include <html_generator/manifest.hpp>
+#include <html_generator/parallel.hpp>
+#include <html_generator/precompress.hpp>
+#include <html_generator/server/block_pool.hpp>
+#include <html_generator/server/byte_range.hpp>
+#include <html_generator/server/connection_limit.hpp>
+#include <html_generator/server/content_encoding.hpp>
+#include <html_generator/server/content_type.hpp>
+#include <html_generator/server/error_counters.hpp>
+#include <html_generator/server/handler_memory.hpp>
+#include <html_generator/server/mapped_file.hpp>
+#include <html_generator/server/response_cache.hpp>
+#include <html_generator/server/serialized_response.hpp>
+#include <html_generator/server/static_files.hpp>
+#include <html_generator/server/validators.hpp>
+#include <html_generator/watch.hpp>
 
 namespace
 {
 
-	boost::system::error_code
-	generate_all_html(ventura::absolute_path snippets_source_code,
-	                  ventura::absolute_path const &existing_output_root,
-	                  boost::string_ref const file_name)
-	{
-		ventura::absolute_path const index_path =
-		    existing_output_root /
-		    ventura::relative_path(file_name.begin(), file_name.end());
-		Si::error_or<Si::file_handle> const index = ventura::overwrite_file(
-		    ventura::safe_c_str(to_os_string(index_path)));
-		if (index.is_error())
-		{
-			std::cerr << "Could not overwrite file " << index_path << '\n';
-			return index.error();
-		}
-
-		Si::file_sink index_sink(index.get().handle);
-		using namespace Si::html;
-
-		static const std::string site_title = "TyRoXx' blog";
-
-		auto page_content = dynamic([
-			&file_name,
-			snippets_source_code = std::move(snippets_source_code)
-		](code_sink & sink)
-		                            {
-			                            auto drafts =
-#include "pages/how-to-choose-an-integer-type.hpp"
-			                                ;
-			                            drafts.generate(sink);
-			                        });
-
-		auto head_content = tags::head(
-		    tag("meta", attribute("charset", "utf-8"), empty) +
-		    tag("meta",
-		        attribute("name", "viewport") +
-		            attribute("content", "width=device-width, initial-scale=1"),
-		        empty) +
-		    tags::title(site_title) +
-		    tag("link",
-		        tags::href("stylesheets.css") + attribute("rel", "stylesheet"),
-		        empty) +
-		    tag("link", tags::href("stylesheets-dark.css") +
-		                    attribute("rel", "stylesheet"),
-		        empty) +
-		    tag("script", attribute("src", "toggleTheme.js"), text(" ")));
-		auto body_content = tags::body(
-		    tags::h1(text(site_title)) +
-		    tags::a(tags::href("#") + attribute("onclick", "toggleTheme()"),
-		            text("Toggle theme")) +
-		    std::move(page_content) +
-#include "pages/footer.hpp"
-		    +tag("script", text("setTheme();")));
-		auto const document =
-		    raw("<!DOCTYPE html>") +
-		    tags::html(std::move(head_content) + std::move(body_content));
-		auto erased_sink = Si::Sink<char, Si::success>::erase(
-		    Si::make_throwing_sink(index_sink));
-		try
-		{
-			document.generate(erased_sink);
-			return {};
-		}
-		catch (boost::system::system_error const &ex)
-		{
-			// TODO: do this without an exception
-			return ex.code();
-		}
-	}
-
-	struct file_client
+	// Keeps slow or idle clients from tying up sockets and memory
+	struct server_limits
 	{
-		boost::asio::ip::tcp::socket socket;
-		beast::streambuf receive_buffer;
-		beast::http::response<beast::http::string_body> response;
+		std::size_t max_connections;
+
+		// for the next request as long as nothing of it has arrived
+		std::chrono::steady_clock::duration idle_timeout;
+
+		// for reading the rest of a request and for writing a response
+		std::chrono::steady_clock::duration io_timeout;
+	};
 
-		explicit file_client(boost::asio::ip::tcp::socket socket,
-		                     beast::streambuf receive_buffer)
-		    : socket(std::move(socket))
-		    , receive_buffer(std::move(receive_buffer))
+	struct file_server
+	{
+		static_files files;
+		server_limits limits;
+		connection_limit connections;
+		error_counters errors;
+
+		// for the connections, of which there are never more than the limit
+		block_pool connection_memory;
+
+		file_server(ventura::absolute_path document_root,
+		            std::size_t const cache_size, server_limits const &limits)
+		    : files(std::move(document_root), cache_size)
+		    , limits(limits)
+		    , connections(limits.max_connections)
+		    , connection_memory(limits.max_connections)
 		{
 		}
 	};
 
-	struct http_client
+	// A response waiting to be sent. head and body point into the cached
+	// response or into generated.
+	struct queued_response
+	{
+		std::shared_ptr<cached_response const> cached;
+		mapped_file mapped_body;
+
+		// what depends on the request, like the head of a 206 response or a
+		// whole error response
+		std::string generated;
+
+		boost::string_ref head;
+		boost::string_ref body;
+	};
+
+	// How many requests that a client sent without waiting for the
+	// responses are answered with one write
+	static std::size_t const max_pipelined_requests = 16;
+
+	// Everything that belongs to one TCP connection. Every pending operation
+	// of the connection holds a shared_ptr to it, so it lives exactly as
+	// long as it is used. A keep-alive connection uses the same object for
+	// all of its requests.
+	struct connection
 	{
+		file_server &server;
 		boost::asio::ip::tcp::socket socket;
+
+		// The handlers of a connection may run on any thread of the server.
+		// The strand keeps the deadline from closing the socket while
+		// another handler of the connection is using it.
+		boost::asio::io_service::strand strand;
+		boost::asio::steady_timer deadline;
+		bool timed_out;
+		handler_memory operation_memory;
+
 		beast::streambuf receive_buffer;
 		beast::http::request<beast::http::string_body> request;
 
-		explicit http_client(boost::asio::ip::tcp::socket socket,
-		                     beast::streambuf receive_buffer)
-		    : socket(std::move(socket))
-		    , receive_buffer(std::move(receive_buffer))
+		// The responses to the requests that arrived together, in the order
+		// of the requests. An array because the string_refs must not move.
+		std::array<queued_response, max_pipelined_requests> responses;
+		std::size_t queued_responses;
+		std::array<boost::asio::const_buffer, 2 * max_pipelined_requests>
+		    send_buffers;
+
+		// whether the connection stays open after the queued responses
+		bool keep_alive;
+
+		// keeps its capacity from one request to the next
+		std::string cache_key;
+
+		// The server has to have acquired a connection from
+		// server.connections for this object.
+		connection(boost::asio::io_service &io, file_server &server)
+		    : server(server)
+		    , socket(io)
+		    , strand(io)
+		    , deadline(io)
+		    , timed_out(false)
+		    , queued_responses(0)
+		    , keep_alive(false)
 		{
 		}
+
+		~connection()
+		{
+			server.connections.release();
+		}
 	};
 
-	void begin_serve(std::shared_ptr<http_client> client,
-	                 ventura::absolute_path const &document_root);
+	// Makes handler run on the strand of client. The operations it completes
+	// are allocated in the memory of the connection.
+	template <class Handler>
+	auto wrap_handler(connection &client, Handler &&handler)
+	{
+		return client.strand.wrap(make_pooled_handler(
+		    client.operation_memory, std::forward<Handler>(handler)));
+	}
+
+	// Closes the socket if the current operation of the connection does not
+	// complete within timeout. The operation then fails.
+	void set_deadline(std::shared_ptr<connection> const &client,
+	                  std::chrono::steady_clock::duration const timeout)
+	{
+		client->deadline.expires_from_now(timeout);
+		client->deadline.async_wait(
+		    wrap_handler(*client, [client](boost::system::error_code const ec)
+		                          {
+			                          // The deadline may have been moved after
+			                          // this wait completed.
+			                          if (!!ec ||
+			                              (client->deadline.expires_at() >
+			                               std::chrono::steady_clock::now()))
+			                          {
+				                          return;
+			                          }
+			                          client->timed_out = true;
+			                          ++client->server.errors.timeouts;
+			                          boost::system::error_code ignored;
+			                          client->socket.close(ignored);
+			                      }));
+	}
+
+	void finish_connection(connection &client)
+	{
+		// the pending wait holds on to the connection
+		client.deadline.cancel();
+		boost::system::error_code ignored;
+		client.socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both,
+		                       ignored);
+	}
 
-	void serve_prepared_response(
-	    std::shared_ptr<file_client> client, bool const is_keep_alive,
-	    ventura::absolute_path const &document_root,
-	    boost::optional<boost::string_ref> const content_type)
+	// Decides how to go on after an operation of the connection completed.
+	// A failed operation closes the connection it happened on and nothing
+	// else. Returns whether the connection is still usable.
+	bool succeeded(connection &client, io_direction const direction,
+	               boost::system::error_code const ec)
 	{
-		client->response.version = 11;
-		client->response.fields.insert(
-		    "Content-Length",
-		    boost::lexical_cast<std::string>(client->response.body.size()));
-		if (content_type)
+		if (client.timed_out)
 		{
-			client->response.fields.insert("Content-Type", *content_type);
+			// the deadline has already counted and closed it
+			return false;
 		}
-		beast::http::async_write(
-		    client->socket, client->response,
-		    [client, is_keep_alive,
-		     document_root](boost::system::error_code const ec)
-		    {
-			    Si::throw_if_error(ec);
-			    if (is_keep_alive)
-			    {
-				    auto http_client_again = std::make_shared<http_client>(
-				        std::move(client->socket),
-				        std::move(client->receive_buffer));
-				    begin_serve(http_client_again, document_root);
-			    }
-			    else
-			    {
-				    client->socket.shutdown(
-				        boost::asio::ip::tcp::socket::shutdown_both);
-			    }
-			});
+		if (!ec)
+		{
+			return true;
+		}
+		client.server.errors.count(direction, ec);
+		// the pending wait holds on to the connection
+		client.deadline.cancel();
+		boost::system::error_code ignored;
+		client.socket.close(ignored);
+		return false;
 	}
 
-	void serve_static_file(std::shared_ptr<file_client> client,
-	                       bool const is_keep_alive,
-	                       ventura::absolute_path const &document_root,
-	                       ventura::absolute_path const &served_document)
+	void begin_serve(std::shared_ptr<connection> const &client);
+
+	void continue_after_response(std::shared_ptr<connection> const &client)
 	{
-		Si::visit<void>(
-		    ventura::read_file(
-		        ventura::safe_c_str(ventura::to_os_string(served_document))),
-		    [&](std::vector<char> content)
-		    {
-			    // TODO: avoid the copy of the content
-			    client->response.body.assign(content.begin(), content.end());
-			    client->response.reason = "OK";
-			    client->response.status = 200;
-			},
-		    [&](boost::system::error_code const ec)
-		    {
-			    std::cerr << "Could not read file " << served_document << ": "
-			              << ec << '\n';
-			    client->response.reason = "Internal Server Error";
-			    client->response.status = 500;
-			    client->response.body = client->response.reason;
-			},
-		    [&](ventura::read_file_problem const problem)
-		    {
-			    std::cerr << "Could not read file " << served_document
-			              << " due to problem " << static_cast<int>(problem)
-			              << '\n';
-			    client->response.reason = "Internal Server Error";
-			    client->response.status = 500;
-			    client->response.body = client->response.reason;
-			});
-		serve_prepared_response(client, is_keep_alive, document_root,
-		                        boost::none);
+		if (client->keep_alive)
+		{
+			begin_serve(client);
+		}
+		else
+		{
+			finish_connection(*client);
+		}
+	}
+
+	// Returns the response that comes after the ones already queued. It
+	// reuses the memory of an earlier one.
+	queued_response &next_response(connection &client)
+	{
+		assert(client.queued_responses < client.responses.size());
+		queued_response &response = client.responses[client.queued_responses];
+		++client.queued_responses;
+		response.generated.clear();
+		response.body.clear();
+		return response;
+	}
+
+	bool is_not_modified(
+	    beast::http::request<beast::http::string_body> const &request,
+	    cached_response const &response)
+	{
+		if ((request.method != "GET") && (request.method != "HEAD"))
+		{
+			return false;
+		}
+		// If-Modified-Since is only looked at if there is no If-None-Match
+		boost::string_ref const if_none_match =
+		    request.fields["If-None-Match"];
+		if (!if_none_match.empty())
+		{
+			return if_none_match_matches(if_none_match, response.etag);
+		}
+		Si::optional<std::time_t> const if_modified_since =
+		    parse_http_date(request.fields["If-Modified-Since"]);
+		return if_modified_since &&
+		       (response.version.last_write_time <= *if_modified_since);
+	}
+
+	requested_range get_requested_range(
+	    beast::http::request<beast::http::string_body> const &request,
+	    cached_response const &response, std::size_t const body_size)
+	{
+		requested_range const whole = {range_kind::whole, 0, body_size};
+		if (request.method != "GET")
+		{
+			return whole;
+		}
+		boost::string_ref const range = request.fields["Range"];
+		if (range.empty())
+		{
+			return whole;
+		}
+		boost::string_ref const if_range = request.fields["If-Range"];
+		if (!if_range.empty() &&
+		    !if_range_matches(if_range, response.etag,
+		                      response.version.last_write_time))
+		{
+			return whole;
+		}
+		return parse_range(range, whole.length);
 	}
 
-	void begin_serve(std::shared_ptr<http_client> client,
-	                 ventura::absolute_path const &document_root)
+	std::string make_range_head(cached_response const &response,
+	                            std::size_t const body_size,
+	                            requested_range const &range)
 	{
+		std::string const total = boost::lexical_cast<std::string>(body_size);
+		std::string head;
+		if (range.kind == range_kind::unsatisfiable)
+		{
+			append_status_line(head, 416, "Range Not Satisfiable");
+			append_field(head, "Content-Length", "0");
+			append_field(head, "Content-Range", "bytes */" + total);
+		}
+		else
+		{
+			append_status_line(head, 206, "Partial Content");
+			append_field(head, "Content-Length",
+			             boost::lexical_cast<std::string>(range.length));
+			append_field(
+			    head, "Content-Range",
+			    "bytes " + boost::lexical_cast<std::string>(range.first) +
+			        '-' + boost::lexical_cast<std::string>(range.first +
+			                                               range.length - 1) +
+			        '/' + total);
+			head += response.representation_fields;
+		}
+		end_head(head);
+		return head;
+	}
+
+	void queue_cached_response(connection &client, static_file_lookup found)
+	{
+		cached_response const &response = *found.response;
+		boost::string_ref const body = found.body();
+		bool const not_modified = is_not_modified(client.request, response);
+		requested_range const range =
+		    not_modified
+		        ? requested_range{range_kind::whole, 0, 0}
+		        : get_requested_range(client.request, response, body.size());
+		queued_response &queued = next_response(client);
+		if (not_modified)
+		{
+			queued.head = response.not_modified_head;
+		}
+		else if (range.kind == range_kind::whole)
+		{
+			queued.head = response.head;
+			queued.body = body;
+		}
+		else
+		{
+			// Only the requested part of the file is sent. As with complete
+			// responses it comes straight from the cached copy or mapping.
+			queued.generated = make_range_head(response, body.size(), range);
+			queued.head = queued.generated;
+			queued.body = body.substr(range.first, range.length);
+		}
+		// moving keeps the addresses that head and body point to
+		queued.cached = std::move(found.response);
+		queued.mapped_body = std::move(found.mapped_body);
+	}
+
+	void queue_error(connection &client, int const status,
+	                 boost::string_ref const reason)
+	{
+		queued_response &queued = next_response(client);
+		std::string &generated = queued.generated;
+		append_status_line(generated, status, reason);
+		append_field(generated, "Content-Length",
+		             boost::lexical_cast<std::string>(reason.size()));
+		append_field(generated, "Content-Type", "text/html");
+		end_head(generated);
+		std::size_t const head_size = generated.size();
+		generated.append(reason.begin(), reason.end());
+		queued.head = boost::string_ref(generated).substr(0, head_size);
+		queued.body = boost::string_ref(generated).substr(head_size);
+	}
+
+	void queue_response(connection &client)
+	{
+		acceptable_encodings const encodings =
+		    negotiate_encodings(client.request.fields["Accept-Encoding"]);
+		static_file_lookup found = client.server.files.find(
+		    client.request.url, encodings, client.cache_key);
+		switch (found.status)
+		{
+		case 200:
+			queue_cached_response(client, std::move(found));
+			break;
+
+		case 400:
+			queue_error(client, 400, "Bad Request");
+			break;
+
+		case 404:
+			queue_error(client, 404, "Not Found");
+			break;
+
+		default:
+			queue_error(client, 500, "Internal Server Error");
+			break;
+		}
+	}
+
+	void handle_request(connection &client)
+	{
+		client.keep_alive = beast::http::is_keep_alive(client.request);
+		queue_response(client);
+		if (client.request.method == "HEAD")
+		{
+			// The client would take a body for the next response.
+			client.responses[client.queued_responses - 1].body.clear();
+		}
+	}
+
+	// Parses the next request if all of it has arrived already. A client
+	// that pipelines sends several requests without waiting for the
+	// responses.
+	bool parse_buffered_request(connection &client)
+	{
+		if (client.receive_buffer.size() == 0)
+		{
+			return false;
+		}
+		beast::http::parser_v1<true, beast::http::string_body,
+		                       beast::http::fields>
+		    parser;
+		boost::system::error_code ec;
+		std::size_t const used = parser.write(client.receive_buffer.data(), ec);
+		if (!!ec || !parser.complete())
+		{
+			// The next read takes care of an incomplete request and reports
+			// a malformed one.
+			return false;
+		}
+		client.receive_buffer.consume(used);
+		client.request = parser.release();
+		return true;
+	}
+
+	void send_responses(std::shared_ptr<connection> const &client)
+	{
+		std::size_t buffer_count = 0;
+		for (std::size_t i = 0; i < client->queued_responses; ++i)
+		{
+			queued_response const &response = client->responses[i];
+			client->send_buffers[buffer_count++] =
+			    boost::asio::buffer(response.head.data(), response.head.size());
+			client->send_buffers[buffer_count++] =
+			    boost::asio::buffer(response.body.data(), response.body.size());
+		}
+		set_deadline(client, client->server.limits.io_timeout);
+		boost::asio::async_write(
+		    client->socket,
+		    boost::make_iterator_range(client->send_buffers.data(),
+		                               client->send_buffers.data() +
+		                                   buffer_count),
+		    wrap_handler(*client, [client](boost::system::error_code const ec,
+		                                   std::size_t)
+		                          {
+			                          if (!succeeded(*client,
+			                                         io_direction::write, ec))
+			                          {
+				                          return;
+			                          }
+			                          // a mapping is not kept alive any longer
+			                          // than necessary
+			                          for (queued_response &sent :
+			                               client->responses)
+			                          {
+				                          sent.cached.reset();
+				                          sent.mapped_body = mapped_file();
+			                          }
+			                          client->queued_responses = 0;
+			                          continue_after_response(client);
+			                      }));
+	}
+
+	// Answers the request that has just been read together with the
+	// complete requests behind it in the receive buffer. All responses are
+	// sent with one write instead of one write and one wakeup each.
+	void handle_requests(std::shared_ptr<connection> const &client)
+	{
+		handle_request(*client);
+		while (client->keep_alive &&
+		       (client->queued_responses < client->responses.size()) &&
+		       parse_buffered_request(*client))
+		{
+			handle_request(*client);
+		}
+		send_responses(client);
+	}
+
+	void read_request(std::shared_ptr<connection> const &client)
+	{
+		set_deadline(client, client->server.limits.io_timeout);
 		beast::http::async_read(
 		    client->socket, client->receive_buffer, client->request,
-		    [client, document_root](boost::system::error_code const ec)
+		    wrap_handler(*client, [client](boost::system::error_code const ec)
+		                          {
+			                          if (!succeeded(*client,
+			                                         io_direction::read, ec))
+			                          {
+				                          return;
+			                          }
+			                          handle_requests(client);
+			                      }));
+	}
+
+	void begin_serve(std::shared_ptr<connection> const &client)
+	{
+		client->request = beast::http::request<beast::http::string_body>();
+		if (client->receive_buffer.size() > 0)
+		{
+			read_request(client);
+			return;
+		}
+		// A connection that does not start its next request soon is closed.
+		// Once a request has begun, the client gets the longer io_timeout
+		// for the rest of it.
+		set_deadline(client, client->server.limits.idle_timeout);
+		client->socket.async_read_some(
+		    boost::asio::null_buffers(),
+		    wrap_handler(*client, [client](boost::system::error_code const ec,
+		                                   std::size_t)
+		                          {
+			                          if (!succeeded(*client,
+			                                         io_direction::read, ec))
+			                          {
+				                          return;
+			                          }
+			                          read_request(client);
+			                      }));
+	}
+
+	// The socket that clients connect to. Accepting is resumed by the thread
+	// that closes a connection while accept handlers run on the other
+	// threads of the server. Everything that touches the acceptor goes
+	// through the strand so that there is never more than one accept in
+	// flight.
+	struct listener
+	{
+		file_server &server;
+		boost::asio::ip::tcp::acceptor acceptor;
+		boost::asio::io_service::strand strand;
+
+		listener(boost::asio::io_service &io, file_server &server,
+		         boost::asio::ip::tcp::endpoint const &endpoint)
+		    : server(server)
+		    , acceptor(io, endpoint, true)
+		    , strand(io)
+		{
+		}
+	};
+
+	void retry_accept_later(listener &accepting);
+
+	void begin_accept(listener &accepting);
+
+	void on_accepted(listener &accepting,
+	                 std::shared_ptr<connection> const &client,
+	                 boost::system::error_code const ec)
+	{
+		if (ec == boost::asio::error::operation_aborted)
+		{
+			// the acceptor was closed
+			return;
+		}
+		if (!!ec)
+		{
+			++accepting.server.errors.accept_errors;
+			// A client that gave up while waiting in the backlog is not a
+			// reason to wait. Running out of descriptors or memory is,
+			// because the next accept would fail again immediately.
+			if (is_disconnect(ec))
+			{
+				begin_accept(accepting);
+			}
+			else
+			{
+				retry_accept_later(accepting);
+			}
+			return;
+		}
+		begin_accept(accepting);
+		begin_serve(client);
+	}
+
+	// Has to run on the strand of accepting.
+	void begin_accept(listener &accepting)
+	{
+		file_server &server = accepting.server;
+		auto const resume = [&accepting]()
+		{
+			accepting.strand.post([&accepting]()
+			                      {
+				                      begin_accept(accepting);
+				                  });
+		};
+		if (!server.connections.try_acquire(resume))
+		{
+			// Accepting continues when a connection is closed. Until then
+			// new clients wait in the backlog of the listening socket.
+			return;
+		}
+		// After a while every new connection reuses the memory of a closed
+		// one.
+		auto client = std::allocate_shared<connection>(
+		    pool_allocator<connection>(server.connection_memory),
+		    accepting.acceptor.get_io_service(), server);
+		accepting.acceptor.async_accept(
+		    client->socket, accepting.strand.wrap(
+		                        [&accepting, client](
+		                            boost::system::error_code const ec)
+		                        {
+			                        on_accepted(accepting, client, ec);
+			                    }));
+	}
+
+	void retry_accept_later(listener &accepting)
+	{
+		auto const delay = std::make_shared<boost::asio::steady_timer>(
+		    accepting.acceptor.get_io_service());
+		delay->expires_from_now(std::chrono::milliseconds(100));
+		delay->async_wait(accepting.strand.wrap(
+		    [delay, &accepting](boost::system::error_code const ec)
 		    {
-			    Si::throw_if_error(ec);
-			    std::shared_ptr<file_client> const new_client =
-			        std::make_shared<file_client>(
-			            std::move(client->socket),
-			            std::move(client->receive_buffer));
-			    if (!client->request.url.empty() &&
-			        (client->request.url.front() == '/'))
+			    if (!ec)
 			    {
-				    boost::filesystem::path requested_file(
-				        client->request.url.begin() + 1,
-				        client->request.url.end());
-				    if (requested_file.empty())
-				    {
-					    requested_file = "index.html";
-				    }
-				    if (requested_file.is_relative())
-				    {
-					    serve_static_file(
-					        new_client,
-					        beast::http::is_keep_alive(client->request),
-					        document_root,
-					        document_root / ventura::relative_path(
-					                            std::move(requested_file)));
-					    return;
-				    }
+				    begin_accept(accepting);
 			    }
-			    new_client->response.reason = "Bad Request";
-			    new_client->response.status = 400;
-			    new_client->response.body = new_client->response.reason;
-			    serve_prepared_response(
-			        new_client, beast::http::is_keep_alive(client->request),
-			        document_root, boost::string_ref("text/html"));
-			});
-	}
-
-	void begin_accept(boost::asio::ip::tcp::acceptor &acceptor,
-	                  ventura::absolute_path const &document_root)
-	{
-		auto client = std::make_shared<http_client>(
-		    boost::asio::ip::tcp::socket(acceptor.get_io_service()),
-		    beast::streambuf());
-		acceptor.async_accept(client->socket,
-		                      [&acceptor, client, document_root](
-		                          boost::system::error_code const ec)
-		                      {
-			                      Si::throw_if_error(ec);
-			                      begin_accept(acceptor, document_root);
-			                      begin_serve(client, document_root);
-			                  });
+			}));
+	}
+
+	// The handlers deal with failed I/O themselves, so an exception that
+	// reaches this point is unexpected, like running out of memory. It is
+	// reported and the thread goes back to serving.
+	void run_until_stopped(boost::asio::io_service &io)
+	{
+		while (!io.stopped())
+		{
+			try
+			{
+				io.run();
+			}
+			catch (boost::system::system_error const &ex)
+			{
+				std::cerr << "boost::system::system_error: " << ex.code()
+				          << '\n';
+			}
+			catch (std::exception const &ex)
+			{
+				std::cerr << "std::exception: " << ex.what() << '\n';
+			}
+		}
+	}
+
+	// Changes whenever the generator is compiled again. The layout of the
+	// pages is compiled into the generator, so this covers changes to it.
+	char const generator_version[] = __DATE__ " " __TIME__;
+
+	// An output is generated again if the hash of its inputs changed or if
+	// the output or one of its compressed variants is missing.
+	bool is_output_current(build_manifest const &manifest,
+	                       ventura::absolute_path const &output_root,
+	                       boost::string_ref const name,
+	                       content_hash const &inputs)
+	{
+		if (!manifest.is_up_to_date(name.to_string(), inputs.to_hex()))
+		{
+			return false;
+		}
+		boost::filesystem::path const output =
+		    (output_root / ventura::relative_path(name.begin(), name.end()))
+		        .to_boost_path();
+		boost::system::error_code ec;
+		return boost::filesystem::exists(output, ec) &&
+		       precompressed_variants_exist(output);
+	}
+
+	// Something to put into the output directory. produce returns a
+	// description of what went wrong or an empty string on success.
+	struct output_task
+	{
+		std::string name;
+		content_hash inputs;
+		std::function<std::string()> produce;
+	};
+
+	std::string describe_failure(boost::system::error_code const ec)
+	{
+		return ec ? boost::lexical_cast<std::string>(ec) : std::string();
+	}
+
+	bool build_site(ventura::absolute_path const &repo,
+	                ventura::absolute_path const &output_root,
+	                build_manifest &manifest,
+	                snippet_cache const &rendered_snippets, unsigned const jobs)
+	{
+		std::vector<output_task> tasks;
+
+		// Copying the assets
+		static std::pair<char const *, char const *> const assets[] = {
+		    {"html_generator/pages/stylesheet.css", "stylesheets.css"},
+		    {"html_generator/pages/stylesheet-dark.css",
+		     "stylesheets-dark.css"},
+		    {"html_generator/pages/toggleTheme.js", "toggleTheme.js"}};
+		for (auto const &asset : assets)
+		{
+			ventura::absolute_path const source =
+			    repo / ventura::relative_path(asset.first);
+			ventura::absolute_path const output =
+			    output_root / ventura::relative_path(asset.second);
+			content_hash inputs;
+			boost::system::error_code const ec =
+			    hash_file(inputs, source.to_boost_path());
+			if (!!ec)
+			{
+				std::cerr << "Could not read file " << source << ": " << ec
+				          << '\n';
+				return false;
+			}
+			tasks.push_back(
+			    {asset.second, inputs, [source, output]()
+			     {
+				     boost::system::error_code const ec = copy_file_atomically(
+				         source.to_boost_path(), output.to_boost_path());
+				     if (!!ec)
+				     {
+					     return "Could not copy " + to_utf8_string(source) +
+					            ": " + describe_failure(ec);
+				     }
+				     // Compressing the outputs ahead of time for the server
+				     return describe_failure(
+				         write_precompressed_variants(output.to_boost_path()));
+				 }});
+		}
+
+		// Generating the files
+		ventura::absolute_path const snippets =
+		    repo / ventura::relative_path("snippets");
+		ventura::absolute_path const posts =
+		    repo / ventura::relative_path("posts");
+		content_hash page_inputs;
+		page_inputs.add_delimited(generator_version);
+		for (ventura::absolute_path const &input : {snippets, posts})
+		{
+			boost::system::error_code const ec =
+			    hash_directory(page_inputs, input.to_boost_path());
+			if (!!ec)
+			{
+				std::cerr << "Could not read the files in " << input << ": "
+				          << ec << '\n';
+				return false;
+			}
+		}
+		static const boost::string_ref files_to_generate[] = {"index.html"};
+		for (boost::string_ref const file : files_to_generate)
+		{
+			tasks.push_back(
+			    {file.to_string(), page_inputs,
+			     [snippets, posts, &output_root, file, &rendered_snippets]()
+			     {
+				     boost::system::error_code const ec =
+				         generate_all_html(snippets, posts, output_root, file,
+				                           &rendered_snippets);
+				     if (!!ec)
+				     {
+					     return describe_failure(ec);
+				     }
+				     return describe_failure(write_precompressed_variants(
+				         (output_root /
+				          ventura::relative_path(file.begin(), file.end()))
+				             .to_boost_path()));
+				 }});
+		}
+
+		// Every output is written by exactly one task and the tasks do not
+		// share any mutable state, so the outputs are the same as if they
+		// were produced one after another.
+		std::vector<std::function<std::string()>> outdated;
+		std::vector<output_task const *> outdated_tasks;
+		for (output_task const &task : tasks)
+		{
+			if (is_output_current(manifest, output_root, task.name,
+			                      task.inputs))
+			{
+				continue;
+			}
+			manifest.forget(task.name);
+			outdated_tasks.emplace_back(&task);
+			outdated.emplace_back([&task]()
+			                      {
+				                      try
+				                      {
+					                      return task.produce();
+				                      }
+				                      catch (std::exception const &ex)
+				                      {
+					                      return std::string(ex.what());
+				                      }
+				                  });
+		}
+		std::vector<std::string> const failures =
+		    run_in_parallel(outdated, jobs);
+
+		// The failures are reported in the order of the tasks, no matter
+		// which one failed first.
+		bool success = true;
+		for (std::size_t i = 0; i < failures.size(); ++i)
+		{
+			output_task const &task = *outdated_tasks[i];
+			if (failures[i].empty())
+			{
+				manifest.record(task.name, task.inputs.to_hex());
+			}
+			else
+			{
+				std::cerr << "Could not generate " << task.name << ": "
+				          << failures[i] << '\n';
+				success = false;
+			}
+		}
+		return success;
+	}
+
+	bool build_and_save(ventura::absolute_path const &repo,
+	                    ventura::absolute_path const &output_root,
+	                    build_manifest &manifest,
+	                    snippet_cache const &rendered_snippets,
+	                    unsigned const jobs)
+	{
+		bool const success = build_site(repo, output_root, manifest,
+		                                rendered_snippets, jobs);
+		// The manifest is saved even after an error so that the outputs
+		// that were completed are not generated again next time.
+		boost::system::error_code const save_error = manifest.save();
+		if (!!save_error)
+		{
+			std::cerr << "Could not save the build manifest: " << save_error
+			          << '\n';
+		}
+		return success;
 	}
+
+#if TYROXX_HAVE_INOTIFY
+	// Generates the outdated outputs whenever one of the inputs changes.
+	// Returns only when the inputs cannot be watched anymore.
+	void watch_and_rebuild(ventura::absolute_path const &repo,
+	                       ventura::absolute_path const &output_root,
+	                       build_manifest &manifest,
+	                       snippet_cache const &rendered_snippets,
+	                       unsigned const jobs, file_server &server)
+	{
+		directory_watcher watcher;
+		for (char const *const inputs :
+		     {"snippets", "posts", "html_generator/pages"})
+		{
+			ventura::absolute_path const directory =
+			    repo / ventura::relative_path(inputs);
+			boost::system::error_code const ec =
+			    watcher.add(directory.to_boost_path());
+			if (!!ec)
+			{
+				std::cerr << "Could not watch " << directory << ": " << ec
+				          << '\n';
+				return;
+			}
+		}
+		std::cerr << "Watching for changes\n";
+		for (;;)
+		{
+			boost::system::error_code const ec = watcher.wait_for_change(100);
+			if (!!ec)
+			{
+				std::cerr << "Could not wait for changes: " << ec << '\n';
+				return;
+			}
+			// A failure is only reported because the next change might
+			// fix it.
+			build_and_save(repo, output_root, manifest, rendered_snippets,
+			               jobs);
+			server.files.forget_cached();
+		}
+	}
+#endif
 }
 
 int main(int argc, const char **argv)
 {
 	std::string output_option;
 	boost::uint16_t web_server_port = 0;
+	std::string cache_directory_option;
+	std::size_t cache_size = 64 * 1024 * 1024;
+	unsigned thread_count = 1;
+	std::size_t max_connections = 1000;
+	unsigned idle_timeout_seconds = 5;
+	unsigned io_timeout_seconds = 30;
+	unsigned jobs = (std::max)(1u, std::thread::hardware_concurrency());
 
 	boost::program_options::options_description desc("Allowed options");
 	desc.add_options()("help", "produce help message")(
 	    "output", boost::program_options::value(&output_option),
 	    "a directory to put the HTML files into")(
+	    "cache-dir", boost::program_options::value(&cache_directory_option),
+	    "where to remember what was generated (default: the output "
+	    "directory with .cache appended)")(
+	    "rebuild", "generate every output even if its inputs did not change")(
+	    "jobs", boost::program_options::value(&jobs),
+	    "number of outputs to generate at the same time (default: number of "
+	    "cores)")(
+	    "watch", "generate the outdated outputs again whenever a snippet, "
+	             "a post or an asset changes (Linux only)")(
 	    "serve", boost::program_options::value(&web_server_port),
-	    "serve the output directory on this port");
+	    "serve the output directory on this port")(
+	    "cache-size", boost::program_options::value(&cache_size),
+	    "bytes of memory for caching served responses (default 64 MiB)")(
+	    "threads", boost::program_options::value(&thread_count),
+	    "number of threads serving HTTP requests (default 1)")(
+	    "max-connections", boost::program_options::value(&max_connections),
+	    "connections to serve at the same time, further clients have to "
+	    "wait (default 1000)")(
+	    "idle-timeout", boost::program_options::value(&idle_timeout_seconds),
+	    "seconds until a connection without a request is closed (default "
+	    "5)")(
+	    "io-timeout", boost::program_options::value(&io_timeout_seconds),
+	    "seconds for receiving a started request or for sending a response "
+	    "(default 30)");
 
 	boost::program_options::positional_options_description positional;
 	positional.add("output", 1);
@@ -313,67 +963,150 @@ int main(int argc, const char **argv)
 	ventura::absolute_path repo = *ventura::parent(
 	    *ventura::parent(*ventura::absolute_path::create(__FILE__)));
 
-	// Copying the assets
-	ventura::copy(
-	    repo / ventura::relative_path("html_generator/pages/stylesheet.css"),
-	    *output_root / ventura::relative_path("stylesheets.css"), Si::return_);
-
-	ventura::copy(repo / ventura::relative_path(
-	                         "html_generator/pages/stylesheet-dark.css"),
-	              *output_root / ventura::relative_path("stylesheets-dark.css"),
-	              Si::return_);
-	ventura::copy(
-	    repo / ventura::relative_path("html_generator/pages/toggleTheme.js"),
-	    *output_root / ventura::relative_path("toggleTheme.js"), Si::return_);
-
-	// Generating the files
-	static const boost::string_ref files_to_generate[] = {"index.html"};
-	for (boost::string_ref const file : files_to_generate)
-	{
-		boost::system::error_code const ec = generate_all_html(
-		    repo / ventura::relative_path("snippets"), *output_root, file);
-		if (!!ec)
+	boost::filesystem::path cache_directory = cache_directory_option;
+	if (cache_directory.empty())
+	{
+		// next to the output so that it is not published with the output
+		boost::filesystem::path output = output_root->to_boost_path();
+		// "out/" has the file name "." and would get the cache "out/.cache"
+		while (output.has_parent_path() && (output.filename() == "."))
 		{
-			std::cerr << ec << '\n';
-			return 1;
+			output = output.parent_path();
 		}
+		cache_directory =
+		    output.parent_path() / (output.filename().string() + ".cache");
+	}
+	build_manifest manifest(cache_directory / "manifest.txt");
+	snippet_cache const rendered_snippets(cache_directory / "snippets",
+	                                      generator_version);
+	if (!vm.count("rebuild"))
+	{
+		manifest.load();
+	}
+	if (jobs < 1)
+	{
+		std::cerr << "At least one job is required for generating.\n";
+		std::cerr << desc << "\n";
+		return 1;
+	}
+	bool const watch = (vm.count("watch") != 0);
+#if !TYROXX_HAVE_INOTIFY
+	if (watch)
+	{
+		std::cerr << "--watch is only supported on Linux.\n";
+		return 1;
+	}
+#endif
+
+	// In watch mode a broken input is reported and then fixed while the
+	// generator keeps running.
+	if (!build_and_save(repo, *output_root, manifest, rendered_snippets,
+	                    jobs) &&
+	    !watch)
+	{
+		return 1;
 	}
 
-	if (!vm.count("serve"))
+	bool const serve = (vm.count("serve") != 0);
+	if (!serve && !watch)
 	{
 		return 0;
 	}
 
+	if (thread_count < 1)
+	{
+		std::cerr << "At least one thread is required for serving.\n";
+		std::cerr << desc << "\n";
+		return 1;
+	}
+
+	if (max_connections < 1)
+	{
+		std::cerr << "At least one connection has to be allowed.\n";
+		std::cerr << desc << "\n";
+		return 1;
+	}
+
+	if ((idle_timeout_seconds < 1) || (io_timeout_seconds < 1))
+	{
+		// a deadline of zero would close every connection right away
+		std::cerr << "The timeouts have to be at least one second.\n";
+		std::cerr << desc << "\n";
+		return 1;
+	}
+	server_limits const limits = {
+	    max_connections, std::chrono::seconds(idle_timeout_seconds),
+	    std::chrono::seconds(io_timeout_seconds)};
+
 	// Starting the server
 	try
 	{
 		using namespace boost::asio;
 
+		// The server outlives the io_service because destroying the
+		// io_service destroys the connections of the pending operations.
+		file_server server(*output_root, cache_size, limits);
 		io_service io;
-
-		ip::tcp::acceptor acceptor_v4(
-		    io, ip::tcp::endpoint(ip::tcp::v4(), web_server_port), true);
-		acceptor_v4.listen();
-		begin_accept(acceptor_v4, *output_root);
-
-		while (!io.stopped())
+		std::unique_ptr<listener> listener_v4;
+		std::vector<std::thread> threads;
+		if (serve)
 		{
-			try
-			{
-				io.run();
-			}
-			catch (boost::system::system_error const &ex)
-			{
-				std::cerr << "boost::system::system_error: " << ex.code()
-				          << '\n';
-				io.reset();
-			}
-			catch (std::exception const &ex)
+			listener_v4 = std::make_unique<listener>(
+			    io, server,
+			    ip::tcp::endpoint(ip::tcp::v4(), web_server_port));
+			listener_v4->acceptor.listen();
+			// no thread is running the io_service yet, so this is as good as
+			// being on the strand
+			begin_accept(*listener_v4);
+
+			// All threads share the io_service. The handlers of a
+			// connection never run concurrently because they are
+			// dispatched through the strand of the connection. In watch
+			// mode the main thread watches instead of serving.
+			for (unsigned i = (watch ? 0 : 1); i < thread_count; ++i)
 			{
-				std::cerr << "std::exception: " << ex.what() << '\n';
-				io.reset();
+				threads.emplace_back([&io]()
+				                     {
+					                     run_until_stopped(io);
+					                 });
 			}
 		}
+		if (watch)
+		{
+#if TYROXX_HAVE_INOTIFY
+			watch_and_rebuild(repo, *output_root, manifest,
+			                  rendered_snippets, jobs, server);
+#endif
+			io.stop();
+		}
+		else
+		{
+			// Without this the server could only be killed, and the error
+			// counters would never be printed. In watch mode the main thread
+			// is busy watching, so the signals keep their default action
+			// there.
+			signal_set stop_signals(io, SIGINT, SIGTERM);
+			stop_signals.async_wait(
+			    [&io](boost::system::error_code const ec, int)
+			    {
+				    if (!ec)
+				    {
+					    io.stop();
+				    }
+				});
+			run_until_stopped(io);
+		}
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+		server.connections.stop_resuming();
+		std::cerr << server.errors << '\n';
+		if (watch)
+		{
+			// watching only ends because of an error
+			return 1;
+		}
 	}
 	catch (boost::system::system_error const &ex)
 	{
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <html_generator/content_hash.hpp>
+#include <html_generator/replace_file.hpp>
+#include <html_generator/server/mapped_file.hpp>
+#include <map>
+#include <vector>
+
+// Adds the name and the content of a file to the hash.
+inline boost::system::error_code hash_file(content_hash &hash,
+                                           boost::filesystem::path const &file)
+{
+	return Si::visit<boost::system::error_code>(
+	    map_file(file),
+	    [&hash, &file](mapped_file const &content)
+	    {
+		    hash.add_delimited(file.filename().string());
+		    hash.add_delimited(
+		        boost::string_ref(content.data(), content.size()));
+		    return boost::system::error_code();
+		},
+	    [](boost::system::error_code const ec)
+	    {
+		    return ec;
+		});
+}
+
+// Adds the regular files in a directory in the order of their names. Adding,
+// removing or renaming a file changes the hash as well.
+inline boost::system::error_code
+hash_directory(content_hash &hash, boost::filesystem::path const &directory)
+{
+	std::vector<boost::filesystem::path> files;
+	boost::system::error_code ec;
+	for (boost::filesystem::directory_iterator i(directory, ec);
+	     !ec && (i != boost::filesystem::directory_iterator()); i.increment(ec))
+	{
+		if (boost::filesystem::is_regular_file(i->status()))
+		{
+			files.emplace_back(i->path());
+		}
+	}
+	if (!!ec)
+	{
+		return ec;
+	}
+	std::sort(files.begin(), files.end());
+	for (boost::filesystem::path const &file : files)
+	{
+		ec = hash_file(hash, file);
+		if (!!ec)
+		{
+			return ec;
+		}
+	}
+	return {};
+}
+
+// Remembers a hash of the inputs of every output of the previous run. An
+// output whose inputs still have the same hash does not have to be generated
+// again.
+class build_manifest
+{
+public:
+	explicit build_manifest(boost::filesystem::path file)
+	    : m_file(std::move(file))
+	{
+	}
+
+	// A missing or damaged manifest only means that everything is generated.
+	void load()
+	{
+		m_input_hashes.clear();
+		boost::filesystem::ifstream in(m_file);
+		std::string line;
+		while (std::getline(in, line))
+		{
+			// "<16 hexadecimal digits> <output>"
+			if ((line.size() > 17) && (line[16] == ' '))
+			{
+				m_input_hashes[line.substr(17)] = line.substr(0, 16);
+			}
+		}
+	}
+
+	bool is_up_to_date(std::string const &output,
+	                   std::string const &input_hash) const
+	{
+		auto const found = m_input_hashes.find(output);
+		return (found != m_input_hashes.end()) && (found->second == input_hash);
+	}
+
+	void record(std::string output, std::string input_hash)
+	{
+		m_input_hashes[std::move(output)] = std::move(input_hash);
+	}
+
+	// Has to be called before an output is overwritten, so that an output
+	// that could not be completed is not taken for up to date later.
+	void forget(std::string const &output)
+	{
+		m_input_hashes.erase(output);
+	}
+
+	// The manifest is written to a temporary file first and then renamed, so
+	// that an interrupted run leaves either the old or the new manifest.
+	boost::system::error_code save() const
+	{
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(m_file.parent_path(), ec);
+		if (!!ec)
+		{
+			return ec;
+		}
+		pending_replacement replacement(m_file);
+		{
+			boost::filesystem::ofstream out(temporary_path_for(m_file),
+			                                std::ios::binary);
+			for (auto const &entry : m_input_hashes)
+			{
+				out << entry.second << ' ' << entry.first << '\n';
+			}
+			out.close();
+			if (!out)
+			{
+				return boost::system::errc::make_error_code(
+				    boost::system::errc::io_error);
+			}
+		}
+		return replacement.commit();
+	}
+
+private:
+	boost::filesystem::path m_file;
+	std::map<std::string, std::string> m_input_hashes;
+};
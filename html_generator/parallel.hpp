@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs independent tasks on up to jobs threads including the calling one.
+// Every thread takes the next task that has not been started yet, so a thread
+// that finishes a short task early simply continues with the next one.
+// The results are in the order of the tasks regardless of which thread ran
+// what. If tasks throw, the exception of the first of them in task order is
+// rethrown after all tasks have finished.
+template <class Result>
+std::vector<Result>
+run_in_parallel(std::vector<std::function<Result()>> const &tasks,
+                unsigned const jobs)
+{
+	std::vector<Result> results(tasks.size());
+	std::vector<std::exception_ptr> exceptions(tasks.size());
+	std::atomic<std::size_t> next_task(0);
+	auto const work = [&tasks, &results, &exceptions, &next_task]()
+	{
+		for (;;)
+		{
+			std::size_t const index = next_task.fetch_add(1);
+			if (index >= tasks.size())
+			{
+				return;
+			}
+			try
+			{
+				results[index] = tasks[index]();
+			}
+			catch (...)
+			{
+				exceptions[index] = std::current_exception();
+			}
+		}
+	};
+	std::size_t const thread_count =
+	    (std::min)(static_cast<std::size_t>((std::max)(jobs, 1u)),
+	               tasks.size());
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < thread_count; ++i)
+	{
+		threads.emplace_back(work);
+	}
+	work();
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	for (std::exception_ptr const &exception : exceptions)
+	{
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+	return results;
+}
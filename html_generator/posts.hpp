@@ -0,0 +1,187 @@
+#pragma once
+
+#include <boost/filesystem/operations.hpp>
+#include <html_generator/snippet_cache.hpp>
+#include <html_generator/tools/all.hpp>
+#include <stdexcept>
+#include <vector>
+#include <ventura/file_operations.hpp>
+
+// Posts are bark_down files in the posts directory that are read when the
+// pages are generated, so a post can be changed without compiling the
+// generator again. A post starts with a front matter:
+//
+// ---
+// title: How to choose an integer type
+// ---
+//
+// The rest is bark_down. A line "@snippet name.cpp" inserts the highlighted
+// file name.cpp from the snippets directory at that point.
+
+struct post
+{
+	std::string title;
+
+	// The whole file as it was read, so that the bark_down text does not
+	// have to be copied out of it. It begins at content_begin.
+	std::vector<char> source;
+	std::size_t content_begin = 0;
+
+	boost::string_ref content() const
+	{
+		return boost::string_ref(source.data() + content_begin,
+		                         source.size() - content_begin);
+	}
+};
+
+// name is only used for error messages
+inline post parse_post(std::vector<char> file, std::string const &name)
+{
+	boost::string_ref source(file.data(), file.size());
+	auto const take_line = [&source]()
+	{
+		std::size_t const end = std::min(source.find('\n'), source.size());
+		boost::string_ref line = source.substr(0, end);
+		source.remove_prefix(std::min(end + 1, source.size()));
+		if (!line.empty() && (line.back() == '\r'))
+		{
+			line.remove_suffix(1);
+		}
+		return line;
+	};
+	if (take_line() != "---")
+	{
+		throw std::runtime_error("The post " + name +
+		                         " has to start with a front matter (---)");
+	}
+	post result;
+	bool has_title = false;
+	for (;;)
+	{
+		if (source.empty())
+		{
+			throw std::runtime_error("The front matter of the post " + name +
+			                         " is not terminated with ---");
+		}
+		boost::string_ref const line = take_line();
+		if (line == "---")
+		{
+			break;
+		}
+		std::size_t const colon = line.find(':');
+		if (colon == boost::string_ref::npos)
+		{
+			throw std::runtime_error("Expected 'key: value' in the front "
+			                         "matter of the post " +
+			                         name + ", but got: " + line.to_string());
+		}
+		// other keys are ignored so that they can be used by tools
+		if (trim_spaces(line.substr(0, colon)) == "title")
+		{
+			result.title = trim_spaces(line.substr(colon + 1)).to_string();
+			has_title = true;
+		}
+	}
+	if (!has_title)
+	{
+		throw std::runtime_error("The post " + name + " has no title");
+	}
+	result.content_begin = file.size() - source.size();
+	result.source = std::move(file);
+	return result;
+}
+
+inline post parse_post(boost::string_ref const source, std::string const &name)
+{
+	return parse_post(std::vector<char>(source.begin(), source.end()), name);
+}
+
+// Without a cache every snippet is highlighted again.
+inline void render_post_content(Si::html::code_sink &sink,
+                                boost::string_ref const content,
+                                ventura::absolute_path const &snippets,
+                                snippet_cache const *const cache)
+{
+	static boost::string_ref const snippet_directive = "@snippet ";
+	// the bark_down text since the last snippet
+	char const *text_begin = content.begin();
+	boost::string_ref rest = content;
+	while (!rest.empty())
+	{
+		std::size_t const line_end = std::min(rest.find('\n'), rest.size());
+		boost::string_ref line = rest.substr(0, line_end);
+		char const *const line_begin = rest.begin();
+		rest.remove_prefix(std::min(line_end + 1, rest.size()));
+		if (!line.starts_with(snippet_directive))
+		{
+			continue;
+		}
+		write_bark_down(sink, make_string_ref(text_begin, line_begin));
+		if (line.ends_with('\r'))
+		{
+			line.remove_suffix(1);
+		}
+		std::string const name =
+		    trim_spaces(line.substr(snippet_directive.size())).to_string();
+		if (cache)
+		{
+			std::vector<char> const source =
+			    read_source_file(snippets / ventura::relative_path(name));
+			write_raw(sink, cache->get(boost::string_ref(source.data(),
+			                                             source.size())));
+		}
+		else
+		{
+			snippet_from_file(snippets, ventura::relative_path(name))
+			    .generate(sink);
+		}
+		text_begin = rest.begin();
+	}
+	write_bark_down(sink, make_string_ref(text_begin, content.end()));
+}
+
+inline auto render_post(post content, ventura::absolute_path snippets,
+                        snippet_cache const *const cache = nullptr)
+{
+	using namespace Si::html;
+	return dynamic([
+		content = std::move(content),
+		snippets = std::move(snippets),
+		cache
+	](code_sink & sink)
+	               {
+		               tags::h2(text(content.title)).generate(sink);
+		               render_post_content(sink, content.content(), snippets,
+		                                   cache);
+		           });
+}
+
+inline post load_post(ventura::absolute_path const &file)
+{
+	return parse_post(read_source_file(file), to_utf8_string(file));
+}
+
+// the files ending with .md in the order of their names
+inline std::vector<ventura::absolute_path>
+find_posts(ventura::absolute_path const &posts)
+{
+	std::vector<boost::filesystem::path> files;
+	for (boost::filesystem::directory_iterator
+	         i(posts.to_boost_path()),
+	     end;
+	     i != end; ++i)
+	{
+		if (boost::filesystem::is_regular_file(i->status()) &&
+		    (i->path().extension() == ".md"))
+		{
+			files.emplace_back(i->path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	std::vector<ventura::absolute_path> result;
+	for (boost::filesystem::path const &file : files)
+	{
+		result.emplace_back(*ventura::absolute_path::create(file));
+	}
+	return result;
+}
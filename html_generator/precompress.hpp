@@ -0,0 +1,139 @@
+#pragma once
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <html_generator/replace_file.hpp>
+#include <html_generator/server/content_encoding.hpp>
+#include <html_generator/server/mapped_file.hpp>
+#include <zlib.h>
+#ifdef TYROXX_HAVE_BROTLI
+#include <brotli/encode.h>
+#include <cstdint>
+#endif
+
+// Compressed variants of the generated files are written next to them at
+// generation time so that the server never has to compress anything while
+// answering a request.
+
+inline Si::optional<std::vector<char>> gzip_compress(char const *data,
+                                                     std::size_t const size)
+{
+	z_stream stream = {};
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED,
+	                 // 16 selects the gzip format instead of zlib
+	                 MAX_WBITS + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return Si::none;
+	}
+	std::vector<char> compressed(
+	    deflateBound(&stream, static_cast<uLong>(size)));
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	stream.avail_in = static_cast<uInt>(size);
+	stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+	stream.avail_out = static_cast<uInt>(compressed.size());
+	int const result = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	if (result != Z_STREAM_END)
+	{
+		return Si::none;
+	}
+	return Si::optional<std::vector<char>>(std::move(compressed));
+}
+
+#ifdef TYROXX_HAVE_BROTLI
+inline Si::optional<std::vector<char>> brotli_compress(char const *data,
+                                                       std::size_t const size)
+{
+	std::vector<char> compressed(BrotliEncoderMaxCompressedSize(size));
+	std::size_t compressed_size = compressed.size();
+	if (!BrotliEncoderCompress(
+	        BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, size,
+	        reinterpret_cast<uint8_t const *>(data), &compressed_size,
+	        reinterpret_cast<uint8_t *>(compressed.data())))
+	{
+		return Si::none;
+	}
+	compressed.resize(compressed_size);
+	return Si::optional<std::vector<char>>(std::move(compressed));
+}
+#endif
+
+inline boost::system::error_code
+write_encoded_variant(boost::filesystem::path const &original,
+                      content_encoding const encoding,
+                      Si::optional<std::vector<char>> const &content)
+{
+	if (!content)
+	{
+		return boost::system::errc::make_error_code(
+		    boost::system::errc::not_enough_memory);
+	}
+	boost::filesystem::path variant = original;
+	variant += encoded_file_suffix(encoding).to_string();
+	{
+		boost::filesystem::ofstream file(temporary_path_for(variant),
+		                                 std::ios::binary);
+		file.write(content->data(),
+		           static_cast<std::streamsize>(content->size()));
+		file.close();
+		if (!file)
+		{
+			boost::system::error_code ignored;
+			boost::filesystem::remove(temporary_path_for(variant), ignored);
+			return boost::system::errc::make_error_code(
+			    boost::system::errc::io_error);
+		}
+	}
+	return replace_with_temporary(variant);
+}
+
+// Writes file.gz (and file.br if Brotli is available) next to the file.
+inline boost::system::error_code
+write_precompressed_variants(boost::filesystem::path const &file)
+{
+	return Si::visit<boost::system::error_code>(
+	    map_file(file),
+	    [&file](mapped_file const &content)
+	    {
+		    boost::system::error_code const ec = write_encoded_variant(
+		        file, content_encoding::gzip,
+		        gzip_compress(content.data(), content.size()));
+#ifdef TYROXX_HAVE_BROTLI
+		    if (!!ec)
+		    {
+			    return ec;
+		    }
+		    return write_encoded_variant(
+		        file, content_encoding::brotli,
+		        brotli_compress(content.data(), content.size()));
+#else
+		    return ec;
+#endif
+		},
+	    [](boost::system::error_code const ec)
+	    {
+		    return ec;
+		});
+}
+
+// Whether write_precompressed_variants has to be called for the file again.
+inline bool precompressed_variants_exist(boost::filesystem::path const &file)
+{
+	boost::filesystem::path variant = file;
+	variant += encoded_file_suffix(content_encoding::gzip).to_string();
+	boost::system::error_code ec;
+	if (!boost::filesystem::exists(variant, ec))
+	{
+		return false;
+	}
+#ifdef TYROXX_HAVE_BROTLI
+	variant = file;
+	variant += encoded_file_suffix(content_encoding::brotli).to_string();
+	if (!boost::filesystem::exists(variant, ec))
+	{
+		return false;
+	}
+#endif
+	return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <boost/filesystem/operations.hpp>
+#include <utility>
+
+// Outputs are written to a temporary file next to them that is then renamed
+// over the previous version. A rename within a directory is atomic, so the
+// server sees either the old or the new file but never a half-written one.
+// Mappings of the old file also stay valid because its inode is not reused
+// while it is mapped.
+
+inline boost::filesystem::path
+temporary_path_for(boost::filesystem::path const &file)
+{
+	boost::filesystem::path temporary = file;
+	temporary += ".tmp";
+	return temporary;
+}
+
+// Renames the temporary file of file over file. The temporary file is
+// removed if that fails.
+inline boost::system::error_code
+replace_with_temporary(boost::filesystem::path const &file)
+{
+	boost::filesystem::path const temporary = temporary_path_for(file);
+	boost::system::error_code ec;
+	boost::filesystem::rename(temporary, file, ec);
+	if (!!ec)
+	{
+		boost::system::error_code ignored;
+		boost::filesystem::remove(temporary, ignored);
+	}
+	return ec;
+}
+
+// Removes the temporary file of file when it goes out of scope unless it has
+// been committed. Writing an output can fail with an exception as well as
+// with an error code, and neither must leave the temporary file behind where
+// it would be served and deployed.
+class pending_replacement
+{
+public:
+	explicit pending_replacement(boost::filesystem::path file)
+	    : m_file(std::move(file))
+	    , m_committed(false)
+	{
+	}
+
+	~pending_replacement()
+	{
+		if (!m_committed)
+		{
+			boost::system::error_code ignored;
+			boost::filesystem::remove(temporary_path_for(m_file), ignored);
+		}
+	}
+
+	pending_replacement(pending_replacement const &) = delete;
+	pending_replacement &operator=(pending_replacement const &) = delete;
+
+	boost::system::error_code commit()
+	{
+		m_committed = true;
+		return replace_with_temporary(m_file);
+	}
+
+private:
+	boost::filesystem::path m_file;
+	bool m_committed;
+};
+
+inline boost::system::error_code
+copy_file_atomically(boost::filesystem::path const &from,
+                     boost::filesystem::path const &to)
+{
+	pending_replacement replacement(to);
+	boost::system::error_code ec;
+	boost::filesystem::copy_file(
+	    from, temporary_path_for(to),
+	    boost::filesystem::copy_option::overwrite_if_exists, ec);
+	if (!!ec)
+	{
+		return ec;
+	}
+	return replacement.commit();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Keeps freed blocks of memory for the next allocation of the same size. The
+// server allocates every connection together with its reference count in a
+// single block of always the same size, so after a while of serving new
+// connections do not cost a heap allocation anymore.
+class block_pool
+{
+public:
+	// No more than max_kept blocks are kept. Once the blocks of the most
+	// connections that are open at the same time are kept, more would never
+	// be used again.
+	explicit block_pool(std::size_t const max_kept)
+	    : m_block_size(0)
+	    , m_max_kept(max_kept)
+	{
+		m_free.reserve(max_kept);
+	}
+
+	~block_pool()
+	{
+		for (void *const block : m_free)
+		{
+			::operator delete(block);
+		}
+	}
+
+	block_pool(block_pool const &) = delete;
+	block_pool &operator=(block_pool const &) = delete;
+
+	void *allocate(std::size_t const size)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_block_size == 0)
+			{
+				// the first allocation determines what is pooled
+				m_block_size = size;
+			}
+			if ((size == m_block_size) && !m_free.empty())
+			{
+				void *const block = m_free.back();
+				m_free.pop_back();
+				return block;
+			}
+		}
+		return ::operator new(size);
+	}
+
+	void deallocate(void *const block, std::size_t const size)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if ((size == m_block_size) && (m_free.size() < m_max_kept))
+			{
+				// cannot allocate because of the reserve in the constructor
+				m_free.push_back(block);
+				return;
+			}
+		}
+		::operator delete(block);
+	}
+
+	std::size_t kept_blocks()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_free.size();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::size_t m_block_size;
+	std::size_t m_max_kept;
+	std::vector<void *> m_free;
+};
+
+// For std::allocate_shared. The pool has to outlive everything allocated
+// from it.
+template <class T>
+struct pool_allocator
+{
+	typedef T value_type;
+
+	block_pool *pool;
+
+	explicit pool_allocator(block_pool &pool)
+	    : pool(&pool)
+	{
+	}
+
+	template <class U>
+	pool_allocator(pool_allocator<U> const &other)
+	    : pool(other.pool)
+	{
+	}
+
+	T *allocate(std::size_t const count)
+	{
+		return static_cast<T *>(pool->allocate(count * sizeof(T)));
+	}
+
+	void deallocate(T *const memory, std::size_t const count)
+	{
+		pool->deallocate(memory, count * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator==(pool_allocator<T> const &left, pool_allocator<U> const &right)
+{
+	return left.pool == right.pool;
+}
+
+template <class T, class U>
+bool operator!=(pool_allocator<T> const &left, pool_allocator<U> const &right)
+{
+	return left.pool != right.pool;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/utility/string_ref.hpp>
+#include <ctime>
+#include <html_generator/server/validators.hpp>
+#include <silicium/optional.hpp>
+
+// Range requests (RFC 7233) for a single byte range. A request for several
+// ranges at once is answered with the whole representation, which the RFC
+// permits and which avoids multipart/byteranges.
+
+enum class range_kind
+{
+	// no usable Range header: send the complete representation
+	whole,
+
+	// send first to first + length - 1 with 206 Partial Content
+	partial,
+
+	// send 416 Range Not Satisfiable
+	unsatisfiable
+};
+
+struct requested_range
+{
+	range_kind kind;
+	std::size_t first;
+	std::size_t length;
+};
+
+namespace
+{
+	namespace detail
+	{
+		inline Si::optional<std::size_t>
+		parse_position(boost::string_ref const digits)
+		{
+			if (digits.empty())
+			{
+				return Si::none;
+			}
+			std::size_t result = 0;
+			for (char const c : digits)
+			{
+				if ((c < '0') || (c > '9'))
+				{
+					return Si::none;
+				}
+				std::size_t const digit = static_cast<std::size_t>(c - '0');
+				if (result > (static_cast<std::size_t>(-1) - digit) / 10)
+				{
+					// larger than any file can be
+					return static_cast<std::size_t>(-1);
+				}
+				result = result * 10 + digit;
+			}
+			return result;
+		}
+	}
+}
+
+// Interprets a Range header for a representation of the given size.
+inline requested_range parse_range(boost::string_ref range,
+                                   std::size_t const size)
+{
+	requested_range const whole = {range_kind::whole, 0, size};
+	if (!range.starts_with("bytes="))
+	{
+		return whole;
+	}
+	range.remove_prefix(6);
+	std::size_t const dash = range.find('-');
+	if ((dash == boost::string_ref::npos) ||
+	    (range.find(',') != boost::string_ref::npos))
+	{
+		return whole;
+	}
+	Si::optional<std::size_t> const first =
+	    detail::parse_position(range.substr(0, dash));
+	Si::optional<std::size_t> const last =
+	    detail::parse_position(range.substr(dash + 1));
+	if (!first)
+	{
+		// "bytes=-500" means the last 500 bytes
+		if (!last || (dash != 0))
+		{
+			return whole;
+		}
+		if ((*last == 0) || (size == 0))
+		{
+			return {range_kind::unsatisfiable, 0, 0};
+		}
+		std::size_t const length = (std::min)(*last, size);
+		return {range_kind::partial, size - length, length};
+	}
+	if (!last && (dash + 1 != range.size()))
+	{
+		return whole;
+	}
+	if (last && (*last < *first))
+	{
+		return whole;
+	}
+	if (*first >= size)
+	{
+		return {range_kind::unsatisfiable, 0, 0};
+	}
+	std::size_t const end = last ? (std::min)(*last, size - 1) : (size - 1);
+	return {range_kind::partial, *first, end - *first + 1};
+}
+
+// If-Range makes the Range header apply only if the representation is still
+// the one the client has a part of. Entity tags are compared strongly, so a
+// weak tag never matches. A date has to be exactly the modification time.
+inline bool if_range_matches(boost::string_ref const if_range,
+                             boost::string_ref const etag,
+                             std::time_t const last_modified)
+{
+	if (if_range.starts_with("W/"))
+	{
+		return false;
+	}
+	if (if_range.starts_with("\""))
+	{
+		return (if_range == etag);
+	}
+	Si::optional<std::time_t> const date = parse_http_date(if_range);
+	return date && (*date == last_modified);
+}
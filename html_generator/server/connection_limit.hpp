@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+// Counts the open connections of the server. When the limit is reached the
+// server stops accepting, so that further clients wait in the listen backlog
+// of the kernel instead of costing a socket and memory each. Accepting is
+// resumed as soon as a connection is closed.
+class connection_limit
+{
+public:
+	explicit connection_limit(std::size_t const max_connections)
+	    : m_max_connections(max_connections)
+	    , m_open(0)
+	{
+	}
+
+	// Returns true if another connection may be opened. Otherwise resume is
+	// called by the release that makes room for it.
+	bool try_acquire(std::function<void()> resume)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_open >= m_max_connections)
+		{
+			m_resume = std::move(resume);
+			return false;
+		}
+		++m_open;
+		return true;
+	}
+
+	void release()
+	{
+		std::function<void()> resume;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_open;
+			resume.swap(m_resume);
+		}
+		// outside of the lock because resume usually acquires again
+		if (resume)
+		{
+			resume();
+		}
+	}
+
+	// For shutting down: releasing a connection does not resume accepting
+	// anymore.
+	void stop_resuming()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_resume = nullptr;
+	}
+
+	std::size_t open_connections()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_open;
+	}
+
+private:
+	std::size_t m_max_connections;
+	std::mutex m_mutex;
+	std::size_t m_open;
+	std::function<void()> m_resume;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/utility/string_ref.hpp>
+
+enum class content_encoding
+{
+	identity,
+	gzip,
+	brotli
+};
+
+// the token used in Accept-Encoding and Content-Encoding
+inline boost::string_ref encoding_token(content_encoding const encoding)
+{
+	switch (encoding)
+	{
+	case content_encoding::identity:
+		return "identity";
+
+	case content_encoding::gzip:
+		return "gzip";
+
+	case content_encoding::brotli:
+		return "br";
+	}
+	return "identity";
+}
+
+// the extension of the precompressed sibling of a file
+inline boost::string_ref encoded_file_suffix(content_encoding const encoding)
+{
+	switch (encoding)
+	{
+	case content_encoding::identity:
+		return "";
+
+	case content_encoding::gzip:
+		return ".gz";
+
+	case content_encoding::brotli:
+		return ".br";
+	}
+	return "";
+}
+
+namespace
+{
+	namespace detail
+	{
+		inline bool is_whitespace(char const c)
+		{
+			return (c == ' ') || (c == '\t');
+		}
+
+		inline boost::string_ref trim_whitespace(boost::string_ref text)
+		{
+			while (!text.empty() && is_whitespace(text.front()))
+			{
+				text.remove_prefix(1);
+			}
+			while (!text.empty() && is_whitespace(text.back()))
+			{
+				text.remove_suffix(1);
+			}
+			return text;
+		}
+
+		// qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+		inline unsigned
+		parse_quality_in_thousandths(boost::string_ref const text)
+		{
+			if (text.empty() || (text.front() != '0'))
+			{
+				return 1000;
+			}
+			unsigned result = 0;
+			unsigned digit_value = 100;
+			for (std::size_t i = 2; (i < text.size()) && (digit_value > 0); ++i)
+			{
+				if ((text[i] < '0') || (text[i] > '9'))
+				{
+					break;
+				}
+				result += static_cast<unsigned>(text[i] - '0') * digit_value;
+				digit_value /= 10;
+			}
+			return result;
+		}
+	}
+}
+
+// Returns the quality (0 to 1000) that an Accept-Encoding header assigns to a
+// content coding. Codings that are not listed get the quality of "*" if
+// present, and 0 otherwise.
+inline unsigned accepted_encoding_quality(boost::string_ref accept_encoding,
+                                          boost::string_ref const coding)
+{
+	unsigned wildcard_quality = 0;
+	while (!accept_encoding.empty())
+	{
+		std::size_t const comma = accept_encoding.find(',');
+		boost::string_ref item = accept_encoding.substr(0, comma);
+		accept_encoding = (comma == boost::string_ref::npos)
+		                      ? boost::string_ref()
+		                      : accept_encoding.substr(comma + 1);
+
+		std::size_t const semicolon = item.find(';');
+		boost::string_ref const name =
+		    detail::trim_whitespace(item.substr(0, semicolon));
+		unsigned quality = 1000;
+		if (semicolon != boost::string_ref::npos)
+		{
+			boost::string_ref const parameter =
+			    detail::trim_whitespace(item.substr(semicolon + 1));
+			if (boost::algorithm::istarts_with(parameter, "q="))
+			{
+				quality =
+				    detail::parse_quality_in_thousandths(parameter.substr(2));
+			}
+		}
+		if (boost::algorithm::iequals(name, coding))
+		{
+			return quality;
+		}
+		if (name == "*")
+		{
+			wildcard_quality = quality;
+		}
+	}
+	return wildcard_quality;
+}
+
+// The encodings worth trying for a request, best first. Identity is always
+// the last resort.
+struct acceptable_encodings
+{
+	std::array<content_encoding, 3> preferred;
+	std::size_t count;
+
+	content_encoding const *begin() const
+	{
+		return preferred.data();
+	}
+
+	content_encoding const *end() const
+	{
+		return preferred.data() + count;
+	}
+};
+
+inline acceptable_encodings
+negotiate_encodings(boost::string_ref const accept_encoding)
+{
+	acceptable_encodings result;
+	result.count = 0;
+	unsigned const brotli_quality = accepted_encoding_quality(
+	    accept_encoding, encoding_token(content_encoding::brotli));
+	unsigned const gzip_quality = accepted_encoding_quality(
+	    accept_encoding, encoding_token(content_encoding::gzip));
+	// brotli wins a tie because it compresses better
+	if (brotli_quality >= gzip_quality)
+	{
+		if (brotli_quality > 0)
+		{
+			result.preferred[result.count++] = content_encoding::brotli;
+		}
+		if (gzip_quality > 0)
+		{
+			result.preferred[result.count++] = content_encoding::gzip;
+		}
+	}
+	else
+	{
+		result.preferred[result.count++] = content_encoding::gzip;
+		if (brotli_quality > 0)
+		{
+			result.preferred[result.count++] = content_encoding::brotli;
+		}
+	}
+	result.preferred[result.count++] = content_encoding::identity;
+	return result;
+}
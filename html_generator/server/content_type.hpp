@@ -0,0 +1,30 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <silicium/optional.hpp>
+
+// Guesses the Content-Type of a file from its extension.
+inline Si::optional<boost::string_ref>
+content_type_from_extension(boost::filesystem::path const &file)
+{
+	static std::pair<char const *, char const *> const known_types[] = {
+	    {".html", "text/html; charset=utf-8"},
+	    {".css", "text/css; charset=utf-8"},
+	    {".js", "application/javascript; charset=utf-8"},
+	    {".txt", "text/plain; charset=utf-8"},
+	    {".svg", "image/svg+xml"},
+	    {".png", "image/png"},
+	    {".jpg", "image/jpeg"},
+	    {".gif", "image/gif"},
+	    {".ico", "image/x-icon"}};
+	boost::filesystem::path const extension = file.extension();
+	for (auto const &known : known_types)
+	{
+		if (extension == known.first)
+		{
+			return boost::string_ref(known.second);
+		}
+	}
+	return Si::none;
+}
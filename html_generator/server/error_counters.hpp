@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <ostream>
+
+// Clients disconnect at any time. That is not an error of the server, so it
+// is counted separately from the failures that may point to a problem.
+inline bool is_disconnect(boost::system::error_code const ec)
+{
+	return (ec == boost::asio::error::eof) ||
+	       (ec == boost::asio::error::connection_reset) ||
+	       (ec == boost::asio::error::connection_aborted) ||
+	       (ec == boost::asio::error::broken_pipe) ||
+	       (ec == boost::asio::error::not_connected);
+}
+
+enum class io_direction
+{
+	read,
+	write
+};
+
+// Failed operations of the server. A failure only ever closes the
+// connection it happened on, so these counters are the only trace left of
+// it. They are updated from all threads of the server.
+struct error_counters
+{
+	std::atomic<std::size_t> accept_errors;
+	std::atomic<std::size_t> read_errors;
+	std::atomic<std::size_t> write_errors;
+	std::atomic<std::size_t> disconnects;
+	std::atomic<std::size_t> timeouts;
+
+	error_counters()
+	    : accept_errors(0)
+	    , read_errors(0)
+	    , write_errors(0)
+	    , disconnects(0)
+	    , timeouts(0)
+	{
+	}
+
+	void count(io_direction const direction,
+	           boost::system::error_code const ec)
+	{
+		if (is_disconnect(ec))
+		{
+			++disconnects;
+		}
+		else if (direction == io_direction::read)
+		{
+			++read_errors;
+		}
+		else
+		{
+			++write_errors;
+		}
+	}
+};
+
+inline std::ostream &operator<<(std::ostream &out,
+                                error_counters const &counters)
+{
+	return out << "accept errors: " << counters.accept_errors
+	           << ", read errors: " << counters.read_errors
+	           << ", write errors: " << counters.write_errors
+	           << ", disconnects: " << counters.disconnects
+	           << ", timeouts: " << counters.timeouts;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/handler_alloc_hook.hpp>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Memory for the pending operations of one connection. Asio allocates every
+// operation and every handler dispatched through a strand. A connection has
+// only a few of them pending at any time (a read or a write, its deadline and
+// what the strand queued), so a few fixed slots make allocating free for the
+// whole life of the connection. Larger or additional requests fall back to
+// the heap.
+class handler_memory
+{
+public:
+	enum
+	{
+		slot_size = 1024,
+		slot_count = 4
+	};
+
+	handler_memory()
+	{
+		for (std::atomic<bool> &used : m_used)
+		{
+			used.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	handler_memory(handler_memory const &) = delete;
+	handler_memory &operator=(handler_memory const &) = delete;
+
+	// May be called from any thread because asio frees the memory of an
+	// operation on whatever thread completed it.
+	void *allocate(std::size_t const size)
+	{
+		if (size <= slot_size)
+		{
+			for (std::size_t i = 0; i < slot_count; ++i)
+			{
+				if (!m_used[i].exchange(true, std::memory_order_acquire))
+				{
+					return &m_slots[i];
+				}
+			}
+		}
+		return ::operator new(size);
+	}
+
+	void deallocate(void *const memory)
+	{
+		for (std::size_t i = 0; i < slot_count; ++i)
+		{
+			if (memory == &m_slots[i])
+			{
+				m_used[i].store(false, std::memory_order_release);
+				return;
+			}
+		}
+		::operator delete(memory);
+	}
+
+private:
+	typedef std::aligned_storage<slot_size>::type slot;
+
+	slot m_slots[slot_count];
+	std::atomic<bool> m_used[slot_count];
+};
+
+// Makes asio allocate the operations of handler from memory
+template <class Handler>
+struct pooled_handler
+{
+	handler_memory *memory;
+	Handler handler;
+
+	template <class... Args>
+	void operator()(Args &&... args)
+	{
+		handler(std::forward<Args>(args)...);
+	}
+
+	friend void *asio_handler_allocate(std::size_t const size,
+	                                   pooled_handler *const this_handler)
+	{
+		return this_handler->memory->allocate(size);
+	}
+
+	friend void asio_handler_deallocate(void *const pointer, std::size_t,
+	                                    pooled_handler *const this_handler)
+	{
+		this_handler->memory->deallocate(pointer);
+	}
+};
+
+template <class Handler>
+pooled_handler<typename std::decay<Handler>::type>
+make_pooled_handler(handler_memory &memory, Handler &&handler)
+{
+	return {&memory, std::forward<Handler>(handler)};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <silicium/variant.hpp>
+
+// A read-only memory mapping of a whole file. The pages are shared with the
+// kernel's page cache, so handing data() to the socket does not copy the
+// content in user space.
+// The mapped file must not be truncated while it is mapped. Replace files by
+// renaming a new version over them instead of overwriting them in place.
+struct mapped_file
+{
+	mapped_file()
+	{
+	}
+
+	explicit mapped_file(boost::interprocess::mapped_region region)
+	    : m_region(std::move(region))
+	{
+	}
+
+	char const *data() const
+	{
+		return static_cast<char const *>(m_region.get_address());
+	}
+
+	std::size_t size() const
+	{
+		return m_region.get_size();
+	}
+
+private:
+	boost::interprocess::mapped_region m_region;
+};
+
+inline Si::variant<mapped_file, boost::system::error_code>
+map_file(boost::filesystem::path const &file)
+{
+	boost::system::error_code ec;
+	boost::uintmax_t const size = boost::filesystem::file_size(file, ec);
+	if (!!ec)
+	{
+		return ec;
+	}
+	if (size == 0)
+	{
+		// empty regions cannot be mapped
+		return mapped_file();
+	}
+	try
+	{
+		boost::interprocess::file_mapping mapping(
+		    file.c_str(), boost::interprocess::read_only);
+		return mapped_file(boost::interprocess::mapped_region(
+		    mapping, boost::interprocess::read_only));
+	}
+	catch (boost::interprocess::interprocess_exception const &ex)
+	{
+		return boost::system::error_code(
+		    static_cast<int>(ex.get_native_error()),
+		    boost::system::system_category());
+	}
+}
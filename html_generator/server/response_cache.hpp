@@ -0,0 +1,203 @@
+#pragma once
+
+#include <boost/filesystem/operations.hpp>
+#include <chrono>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <silicium/optional.hpp>
+#include <string>
+#include <unordered_map>
+
+struct file_version
+{
+	boost::uintmax_t size;
+	std::time_t last_write_time;
+};
+
+inline bool operator==(file_version const &left, file_version const &right)
+{
+	return (left.size == right.size) &&
+	       (left.last_write_time == right.last_write_time);
+}
+
+inline bool operator!=(file_version const &left, file_version const &right)
+{
+	return !(left == right);
+}
+
+inline Si::optional<file_version>
+get_file_version(boost::filesystem::path const &file)
+{
+	boost::system::error_code ec;
+	file_version result;
+	result.size = boost::filesystem::file_size(file, ec);
+	if (!!ec)
+	{
+		return Si::none;
+	}
+	result.last_write_time = boost::filesystem::last_write_time(file, ec);
+	if (!!ec)
+	{
+		return Si::none;
+	}
+	return result;
+}
+
+// Everything needed to answer a request for the file at source. The heads
+// (status line and header) of the possible responses are serialized in
+// advance.
+struct cached_response
+{
+	boost::filesystem::path source;
+	file_version version;
+	std::string etag;
+	std::string head;
+	std::string not_modified_head;
+
+	// the header fields that describe the body, for building the heads of
+	// partial responses
+	std::string representation_fields;
+
+	// Small files are copied into memory together with their heads. The
+	// body of a larger file is not part of the cached response. It is
+	// mapped again for every response, so that no mapping lives on in the
+	// cache, where truncating the file in place would turn into a SIGBUS
+	// for the whole server. The size of such a body is version.size.
+	bool body_copied = false;
+	std::string copied_body;
+
+	// Remembers that source does not exist, so that a request for an
+	// encoding that was not generated does not have to look for the file
+	// every time. Such a response is never sent.
+	bool missing = false;
+};
+
+// Keeps serialized responses in memory, keyed by URL path. The total size of
+// the cached responses is limited and the least recently used responses are
+// evicted first.
+// A cached response is compared with the size and modification time of its
+// source file at most once per revalidation interval. In between, hits are
+// served without touching the file system at all.
+class response_cache
+{
+public:
+	typedef std::chrono::steady_clock clock;
+
+	response_cache(std::size_t const max_bytes,
+	               clock::duration const revalidation_interval)
+	    : m_max_bytes(max_bytes)
+	    , m_used_bytes(0)
+	    , m_revalidation_interval(revalidation_interval)
+	{
+	}
+
+	std::shared_ptr<cached_response const> find(std::string const &key,
+	                                            clock::time_point const now)
+	{
+		auto const found = m_index.find(key);
+		if (found == m_index.end())
+		{
+			return nullptr;
+		}
+		entry &existing = *found->second;
+		if ((now - existing.last_validated) >= m_revalidation_interval)
+		{
+			Si::optional<file_version> const current =
+			    get_file_version(existing.response->source);
+			bool const unchanged =
+			    existing.response->missing
+			        ? !current
+			        : (current && (*current == existing.response->version));
+			if (!unchanged)
+			{
+				erase(found->second);
+				return nullptr;
+			}
+			existing.last_validated = now;
+		}
+		m_lru.splice(m_lru.begin(), m_lru, found->second);
+		return existing.response;
+	}
+
+	// Returns false if the response is too large to be cached.
+	bool insert(std::string key,
+	            std::shared_ptr<cached_response const> response,
+	            clock::time_point const now)
+	{
+		std::size_t const cost = entry_cost(key, *response);
+		if (cost > max_entry_bytes())
+		{
+			return false;
+		}
+		auto const existing = m_index.find(key);
+		if (existing != m_index.end())
+		{
+			erase(existing->second);
+		}
+		while ((m_max_bytes - m_used_bytes) < cost)
+		{
+			erase(std::prev(m_lru.end()));
+		}
+		m_lru.push_front(entry{key, std::move(response), now});
+		m_index.insert(std::make_pair(std::move(key), m_lru.begin()));
+		m_used_bytes += cost;
+		return true;
+	}
+
+	// For when the files are known to have changed, for example because they
+	// were just generated. Responses that are still being sent are kept
+	// alive by their shared_ptr.
+	void clear()
+	{
+		m_index.clear();
+		m_lru.clear();
+		m_used_bytes = 0;
+	}
+
+	// A single large file should not be able to push out all the small ones.
+	std::size_t max_entry_bytes() const
+	{
+		return m_max_bytes / 8;
+	}
+
+	std::size_t used_bytes() const
+	{
+		return m_used_bytes;
+	}
+
+	std::size_t entry_count() const
+	{
+		return m_index.size();
+	}
+
+private:
+	struct entry
+	{
+		std::string key;
+		std::shared_ptr<cached_response const> response;
+		clock::time_point last_validated;
+	};
+
+	std::size_t m_max_bytes;
+	std::size_t m_used_bytes;
+	clock::duration m_revalidation_interval;
+	std::list<entry> m_lru;
+	std::unordered_map<std::string, std::list<entry>::iterator> m_index;
+
+	static std::size_t entry_cost(std::string const &key,
+	                              cached_response const &response)
+	{
+		return key.size() + response.etag.size() + response.head.size() +
+		       response.not_modified_head.size() +
+		       response.representation_fields.size() +
+		       response.copied_body.size();
+	}
+
+	void erase(std::list<entry>::iterator const which)
+	{
+		m_used_bytes -= entry_cost(which->key, *which->response);
+		m_index.erase(which->key);
+		m_lru.erase(which);
+	}
+};
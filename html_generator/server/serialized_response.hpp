@@ -0,0 +1,33 @@
+#pragma once
+
+#include <boost/lexical_cast.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <string>
+
+// Helpers for writing an HTTP/1.1 response head directly into a string. This
+// is used for responses that are kept around in serialized form so that they
+// can be sent without going through Beast's serializer again.
+
+inline void append_status_line(std::string &out, int const status,
+                               boost::string_ref const reason)
+{
+	out += "HTTP/1.1 ";
+	out += boost::lexical_cast<std::string>(status);
+	out += ' ';
+	out.append(reason.begin(), reason.end());
+	out += "\r\n";
+}
+
+inline void append_field(std::string &out, boost::string_ref const name,
+                         boost::string_ref const value)
+{
+	out.append(name.begin(), name.end());
+	out += ": ";
+	out.append(value.begin(), value.end());
+	out += "\r\n";
+}
+
+inline void end_head(std::string &out)
+{
+	out += "\r\n";
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <html_generator/server/content_encoding.hpp>
+#include <html_generator/server/content_type.hpp>
+#include <html_generator/server/mapped_file.hpp>
+#include <html_generator/server/response_cache.hpp>
+#include <html_generator/server/serialized_response.hpp>
+#include <html_generator/server/validators.hpp>
+#include <iostream>
+#include <mutex>
+#include <ventura/file_operations.hpp>
+
+// The body is only copied into the response if copy_body is set.
+inline std::shared_ptr<cached_response const>
+load_response(boost::filesystem::path const &source,
+              file_version const &version, boost::string_ref const content,
+              Si::optional<boost::string_ref> const content_type,
+              content_encoding const encoding, bool const copy_body)
+{
+	auto response = std::make_shared<cached_response>();
+	response->source = source;
+	response->version = version;
+	response->etag = make_strong_etag(content);
+	std::string const last_modified =
+	    format_http_date(version.last_write_time);
+
+	std::string &fields = response->representation_fields;
+	if (content_type)
+	{
+		append_field(fields, "Content-Type", *content_type);
+	}
+	if (encoding != content_encoding::identity)
+	{
+		append_field(fields, "Content-Encoding", encoding_token(encoding));
+	}
+	append_field(fields, "Vary", "Accept-Encoding");
+	append_field(fields, "ETag", response->etag);
+	append_field(fields, "Last-Modified", last_modified);
+
+	std::string &head = response->head;
+	append_status_line(head, 200, "OK");
+	append_field(head, "Content-Length",
+	             boost::lexical_cast<std::string>(content.size()));
+	append_field(head, "Accept-Ranges", "bytes");
+	head += fields;
+	end_head(head);
+
+	std::string &not_modified_head = response->not_modified_head;
+	append_status_line(not_modified_head, 304, "Not Modified");
+	append_field(not_modified_head, "Vary", "Accept-Encoding");
+	append_field(not_modified_head, "ETag", response->etag);
+	append_field(not_modified_head, "Last-Modified", last_modified);
+	end_head(not_modified_head);
+
+	if (copy_body)
+	{
+		response->body_copied = true;
+		response->copied_body.assign(content.data(), content.size());
+	}
+	return response;
+}
+
+// The key is assigned instead of returned so that its capacity can be
+// reused.
+inline void assign_cache_key(std::string &key, std::string const &url,
+                             content_encoding const encoding)
+{
+	key = url;
+	if (encoding != content_encoding::identity)
+	{
+		// a space cannot be part of the URL
+		key += ' ';
+		boost::string_ref const token = encoding_token(encoding);
+		key.append(token.data(), token.size());
+	}
+}
+
+struct static_file_lookup
+{
+	// null unless status is 200
+	std::shared_ptr<cached_response const> response;
+	int status;
+
+	// the body of a response that does not have a copy of it
+	mapped_file mapped_body;
+
+	boost::string_ref body() const
+	{
+		if (response->body_copied)
+		{
+			return response->copied_body;
+		}
+		return boost::string_ref(mapped_body.data(), mapped_body.size());
+	}
+};
+
+// The generated files and their compressed siblings with a cache of their
+// responses. It may be used from several threads.
+class static_files
+{
+public:
+	static_files(ventura::absolute_path root, std::size_t const cache_size)
+	    : m_root(std::move(root))
+	    , m_responses(cache_size, std::chrono::seconds(1))
+	    , m_metadata(metadata_cache_size, std::chrono::seconds(1))
+	{
+	}
+
+	// Finds the response for url in the first of encodings, in the order of
+	// the client's preference, that the generator wrote a file for. Whether
+	// the file of an encoding exists is cached like the responses, so a
+	// cache hit never touches the file system apart from mapping a body
+	// that is too large to be copied. key is only a parameter so that its
+	// capacity can be reused from one request to the next.
+	static_file_lookup find(std::string const &url,
+	                        acceptable_encodings const &encodings,
+	                        std::string &key)
+	{
+		if (url.empty() || (url.front() != '/'))
+		{
+			return {nullptr, 400};
+		}
+		auto const now = response_cache::clock::now();
+		// only a cache miss needs the path of the file
+		Si::optional<boost::filesystem::path> document;
+		for (content_encoding const encoding : encodings)
+		{
+			assign_cache_key(key, url, encoding);
+			std::shared_ptr<cached_response const> cached =
+			    find_cached(key, now);
+			if (cached)
+			{
+				if (cached->missing)
+				{
+					continue;
+				}
+				if (cached->body_copied)
+				{
+					return {std::move(cached), 200};
+				}
+				mapped_file body;
+				if (map_unchanged_body(*cached, body))
+				{
+					return {std::move(cached), 200, std::move(body)};
+				}
+				// The file changed since its response was cached, so it is
+				// loaded again.
+			}
+			if (!document)
+			{
+				document = document_path(url);
+				if (!document)
+				{
+					return {nullptr, 400};
+				}
+			}
+			boost::filesystem::path file = *document;
+			file += encoded_file_suffix(encoding).to_string();
+
+			// The version is determined before reading the content so that a
+			// concurrent modification makes the cache entry look outdated
+			// rather than current.
+			Si::optional<file_version> const version = get_file_version(file);
+			if (!version)
+			{
+				auto missing = std::make_shared<cached_response>();
+				missing->source = std::move(file);
+				missing->missing = true;
+				cache_metadata(key, std::move(missing), now);
+				continue;
+			}
+			return load(*document, file, *version, encoding, key, now);
+		}
+		return {nullptr, 404};
+	}
+
+	// Without this a regenerated file could be served from the cache for up
+	// to a second. The modification time of a file that changes twice within
+	// a second might not change at all.
+	void forget_cached()
+	{
+		std::lock_guard<std::mutex> lock(m_cache_mutex);
+		m_responses.clear();
+		m_metadata.clear();
+	}
+
+private:
+	// The responses without a body need a few hundred bytes each. They have
+	// a budget of their own so that even a server without a response cache
+	// hashes every file only once.
+	static std::size_t const metadata_cache_size = 4 * 1024 * 1024;
+
+	ventura::absolute_path m_root;
+	std::mutex m_cache_mutex;
+	// responses with a copy of their body
+	response_cache m_responses;
+	// responses of files too large to be copied and missing files
+	response_cache m_metadata;
+
+	std::shared_ptr<cached_response const>
+	find_cached(std::string const &key,
+	            response_cache::clock::time_point const now)
+	{
+		std::lock_guard<std::mutex> lock(m_cache_mutex);
+		std::shared_ptr<cached_response const> found =
+		    m_responses.find(key, now);
+		if (!found)
+		{
+			found = m_metadata.find(key, now);
+		}
+		return found;
+	}
+
+	void cache_response(std::string key,
+	                    std::shared_ptr<cached_response const> response,
+	                    response_cache::clock::time_point const now)
+	{
+		std::lock_guard<std::mutex> lock(m_cache_mutex);
+		m_responses.insert(std::move(key), std::move(response), now);
+	}
+
+	void cache_metadata(std::string key,
+	                    std::shared_ptr<cached_response const> response,
+	                    response_cache::clock::time_point const now)
+	{
+		std::lock_guard<std::mutex> lock(m_cache_mutex);
+		m_metadata.insert(std::move(key), std::move(response), now);
+	}
+
+	// The ETag and the heads of response are only correct for the body if
+	// the file still has the size they were made for. A change of the
+	// modification time alone is noticed by the revalidation of the cache.
+	static bool map_unchanged_body(cached_response const &response,
+	                               mapped_file &body)
+	{
+		return Si::visit<bool>(
+		    map_file(response.source),
+		    [&](mapped_file &content)
+		    {
+			    if (content.size() != response.version.size)
+			    {
+				    return false;
+			    }
+			    body = std::move(content);
+			    return true;
+			},
+		    [](boost::system::error_code)
+		    {
+			    return false;
+			});
+	}
+
+	static bool is_safe_segment(boost::string_ref const segment)
+	{
+		// a backslash separates directories on Windows
+		return !segment.empty() && (segment != ".") && (segment != "..") &&
+		       (segment.find('\\') == boost::string_ref::npos);
+	}
+
+	// None if url could name something outside of the root, like
+	// "/../etc/passwd". Empty, "." and ".." segments are rejected before
+	// the file system is asked about anything.
+	Si::optional<boost::filesystem::path>
+	document_path(std::string const &url) const
+	{
+		// "/" is the only URL with an empty segment
+		if (url.size() > 1)
+		{
+			boost::string_ref segments = boost::string_ref(url).substr(1);
+			for (;;)
+			{
+				std::size_t const end = segments.find('/');
+				boost::string_ref const segment = segments.substr(0, end);
+				if (!is_safe_segment(segment))
+				{
+					return Si::none;
+				}
+				if (end == boost::string_ref::npos)
+				{
+					break;
+				}
+				segments.remove_prefix(end + 1);
+			}
+		}
+		boost::filesystem::path requested_file(url.begin() + 1, url.end());
+		if (requested_file.empty())
+		{
+			requested_file = "index.html";
+		}
+		if (!requested_file.is_relative())
+		{
+			return Si::none;
+		}
+		return (m_root / ventura::relative_path(std::move(requested_file)))
+		    .to_boost_path();
+	}
+
+	static_file_lookup load(boost::filesystem::path const &document,
+	                        boost::filesystem::path const &file,
+	                        file_version const &version,
+	                        content_encoding const encoding,
+	                        std::string const &key,
+	                        response_cache::clock::time_point const now)
+	{
+		// The file is mapped instead of read so that the body goes from the
+		// page cache to the socket without being copied in user space. Small
+		// files are copied into the cache once. Larger ones are mapped again
+		// for every response and the mapping is released when it has been
+		// sent, so that no mapping outlives a request. Only their ETag and
+		// heads are cached, so that the file is hashed once per version.
+		return Si::visit<static_file_lookup>(
+		    map_file(file),
+		    [&](mapped_file &content)
+		    {
+			    bool const copy_body =
+			        (content.size() <= m_responses.max_entry_bytes());
+			    std::shared_ptr<cached_response const> response =
+			        load_response(
+			            file, version,
+			            boost::string_ref(content.data(), content.size()),
+			            content_type_from_extension(document), encoding,
+			            copy_body);
+			    if (copy_body)
+			    {
+				    cache_response(key, response, now);
+				    return static_file_lookup{std::move(response), 200};
+			    }
+			    cache_metadata(key, response, now);
+			    return static_file_lookup{std::move(response), 200,
+			                              std::move(content)};
+			},
+		    [&](boost::system::error_code const ec)
+		    {
+			    std::cerr << "Could not map file " << file << ": " << ec
+			              << '\n';
+			    return static_file_lookup{nullptr, 500};
+			});
+	}
+};
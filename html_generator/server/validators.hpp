@@ -0,0 +1,170 @@
+#pragma once
+
+#include <boost/date_time/posix_time/conversion.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <ctime>
+#include <html_generator/content_hash.hpp>
+#include <silicium/optional.hpp>
+#include <string>
+
+// Validators for conditional requests (RFC 7232).
+
+// A strong entity tag derived from the content. It is computed once when a
+// file is loaded into the response cache.
+inline std::string make_strong_etag(boost::string_ref const content)
+{
+	content_hash hash;
+	hash.add(content);
+	return '"' + hash.to_hex() + '"';
+}
+
+namespace
+{
+	namespace detail
+	{
+		inline boost::string_ref opaque_tag(boost::string_ref entity_tag)
+		{
+			if (entity_tag.starts_with("W/"))
+			{
+				entity_tag.remove_prefix(2);
+			}
+			return entity_tag;
+		}
+
+		static char const *const week_days[] = {"Sun", "Mon", "Tue", "Wed",
+		                                        "Thu", "Fri", "Sat"};
+
+		static char const *const month_names[] = {"Jan", "Feb", "Mar", "Apr",
+		                                          "May", "Jun", "Jul", "Aug",
+		                                          "Sep", "Oct", "Nov", "Dec"};
+
+		inline void append_two_digits(std::string &out, long const value)
+		{
+			out += static_cast<char>('0' + (value / 10) % 10);
+			out += static_cast<char>('0' + value % 10);
+		}
+
+		inline Si::optional<unsigned>
+		parse_digits(boost::string_ref const digits)
+		{
+			unsigned result = 0;
+			for (char const c : digits)
+			{
+				if ((c < '0') || (c > '9'))
+				{
+					return Si::none;
+				}
+				result = result * 10 + static_cast<unsigned>(c - '0');
+			}
+			return result;
+		}
+	}
+}
+
+// If-None-Match uses the weak comparison: "W/" prefixes are ignored.
+inline bool if_none_match_matches(boost::string_ref if_none_match,
+                                  boost::string_ref const etag)
+{
+	boost::string_ref const expected = detail::opaque_tag(etag);
+	while (!if_none_match.empty())
+	{
+		std::size_t const comma = if_none_match.find(',');
+		boost::string_ref item = if_none_match.substr(0, comma);
+		if_none_match = (comma == boost::string_ref::npos)
+		                    ? boost::string_ref()
+		                    : if_none_match.substr(comma + 1);
+		while (!item.empty() && (item.front() == ' '))
+		{
+			item.remove_prefix(1);
+		}
+		while (!item.empty() && (item.back() == ' '))
+		{
+			item.remove_suffix(1);
+		}
+		if ((item == "*") || (detail::opaque_tag(item) == expected))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Formats a time as an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+inline std::string format_http_date(std::time_t const time)
+{
+	boost::posix_time::ptime const utc = boost::posix_time::from_time_t(time);
+	boost::gregorian::date const date = utc.date();
+	boost::posix_time::time_duration const time_of_day = utc.time_of_day();
+	std::string result;
+	result.reserve(29);
+	result += detail::week_days[date.day_of_week().as_number()];
+	result += ", ";
+	detail::append_two_digits(result, date.day());
+	result += ' ';
+	result += detail::month_names[date.month() - 1];
+	result += ' ';
+	detail::append_two_digits(result, date.year() / 100);
+	detail::append_two_digits(result, date.year() % 100);
+	result += ' ';
+	detail::append_two_digits(result, time_of_day.hours());
+	result += ':';
+	detail::append_two_digits(result, time_of_day.minutes());
+	result += ':';
+	detail::append_two_digits(result, time_of_day.seconds());
+	result += " GMT";
+	return result;
+}
+
+// Parses an IMF-fixdate. The obsolete date formats are not supported. Their
+// only effect is that the request is answered as if it was unconditional.
+inline Si::optional<std::time_t> parse_http_date(boost::string_ref const text)
+{
+	// "Sun, 06 Nov 1994 08:49:37 GMT"
+	if ((text.size() != 29) || (text.substr(3, 2) != ", ") ||
+	    (text[7] != ' ') || (text[11] != ' ') || (text[16] != ' ') ||
+	    (text[19] != ':') || (text[22] != ':') || (text.substr(25) != " GMT"))
+	{
+		return Si::none;
+	}
+	Si::optional<unsigned> const day = detail::parse_digits(text.substr(5, 2));
+	Si::optional<unsigned> const year =
+	    detail::parse_digits(text.substr(12, 4));
+	Si::optional<unsigned> const hours =
+	    detail::parse_digits(text.substr(17, 2));
+	Si::optional<unsigned> const minutes =
+	    detail::parse_digits(text.substr(20, 2));
+	Si::optional<unsigned> const seconds =
+	    detail::parse_digits(text.substr(23, 2));
+	if (!day || !year || !hours || !minutes || !seconds || (*hours > 23) ||
+	    (*minutes > 59) || (*seconds > 60) || (*year < 1970))
+	{
+		return Si::none;
+	}
+	boost::string_ref const month_name = text.substr(8, 3);
+	unsigned short month = 0;
+	while ((month < 12) && (month_name != detail::month_names[month]))
+	{
+		++month;
+	}
+	if (month == 12)
+	{
+		return Si::none;
+	}
+	try
+	{
+		boost::gregorian::date const date(
+		    static_cast<unsigned short>(*year),
+		    static_cast<unsigned short>(month + 1),
+		    static_cast<unsigned short>(*day));
+		boost::posix_time::ptime const time(
+		    date, boost::posix_time::time_duration(*hours, *minutes, *seconds));
+		return static_cast<std::time_t>(
+		    (time - boost::posix_time::from_time_t(0)).total_seconds());
+	}
+	catch (std::out_of_range const &)
+	{
+		// for example February 30
+		return Si::none;
+	}
+}
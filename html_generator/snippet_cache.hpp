@@ -0,0 +1,89 @@
+#pragma once
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <html_generator/content_hash.hpp>
+#include <html_generator/replace_file.hpp>
+#include <html_generator/tools/all.hpp>
+
+// Remembers the highlighted HTML of snippets on disk across builds. An
+// entry is named after the hash of the snippet source and of the version of
+// the renderer, so a changed snippet or a changed highlighter simply misses
+// the cache. Outdated entries are never read again and can be deleted
+// together with the whole cache directory at any time.
+class snippet_cache
+{
+public:
+	snippet_cache(boost::filesystem::path directory,
+	              std::string renderer_version)
+	    : m_directory(std::move(directory))
+	    , m_renderer_version(std::move(renderer_version))
+	{
+	}
+
+	// Safe to call from several threads at the same time.
+	std::string get(boost::string_ref const source) const
+	{
+		boost::filesystem::path const entry = entry_path(source);
+		{
+			boost::filesystem::ifstream file(entry, std::ios::binary);
+			if (file)
+			{
+				std::string html((std::istreambuf_iterator<char>(file)),
+				                 std::istreambuf_iterator<char>());
+				if (!file.bad())
+				{
+					return html;
+				}
+			}
+		}
+		std::string html = render_snippet_html(source);
+		// The cache is only an optimization, so failing to write it is not
+		// an error.
+		store(entry, html);
+		return html;
+	}
+
+private:
+	boost::filesystem::path m_directory;
+	std::string m_renderer_version;
+
+	boost::filesystem::path entry_path(boost::string_ref const source) const
+	{
+		content_hash hash;
+		hash.add_delimited(m_renderer_version);
+		hash.add(source);
+		return m_directory / (hash.to_hex() + ".html");
+	}
+
+	void store(boost::filesystem::path const &entry,
+	           std::string const &html) const
+	{
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(m_directory, ec);
+		if (!!ec)
+		{
+			return;
+		}
+		// Two jobs may render the same snippet at the same time, so every
+		// writer needs its own temporary file.
+		boost::filesystem::path const temporary =
+		    temporary_path_for(entry.string() + "." +
+		                       boost::filesystem::unique_path().string());
+		{
+			boost::filesystem::ofstream file(temporary, std::ios::binary);
+			file.write(html.data(), static_cast<std::streamsize>(html.size()));
+			file.close();
+			if (!file)
+			{
+				boost::filesystem::remove(temporary, ec);
+				return;
+			}
+		}
+		boost::filesystem::rename(temporary, entry, ec);
+		if (!!ec)
+		{
+			boost::filesystem::remove(temporary, ec);
+		}
+	}
+};
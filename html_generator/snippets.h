@@ -1,37 +1,138 @@
 #pragma once
 #include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <silicium/optional.hpp>
 #include <silicium/variant.hpp>
 #include <ventura/read_file.hpp>
 
-auto inline_code(std::string code)
+inline auto inline_code(std::string code)
 {
     return tags::span(tags::cl("inlineCodeSnippet"),
                       render_code(std::move(code)));
 }
 
-template <class StringLike>
-auto make_code_snippet(StringLike const &code)
+// Like inline_code, but the code has to outlive the element.
+inline auto inline_code_view(boost::string_ref const code)
 {
-    using namespace Si::html;
-    std::size_t const lines =
-            std::count(std::begin(code), std::end(code), '\n') + 1;
+    return tags::span(tags::cl("inlineCodeSnippet"), render_code_view(code));
+}
+
+// "1\n2\n...lines\n" with the exact capacity
+inline std::string make_line_numbers(std::size_t const lines)
+{
+    std::size_t size = 0;
+    for (std::size_t digits = 1, first = 1; first <= lines;
+         ++digits, first *= 10)
+    {
+        size += ((std::min)(lines, first * 10 - 1) - first + 1) * (digits + 1);
+    }
     std::string line_numbers;
+    line_numbers.reserve(size);
+    char digits[24];
     for (std::size_t i = 1; i <= lines; ++i)
     {
-        line_numbers += boost::lexical_cast<std::string>(i);
+        char *const end = digits + sizeof(digits);
+        char *begin = end;
+        for (std::size_t rest = i; rest != 0; rest /= 10)
+        {
+            *--begin = static_cast<char>('0' + (rest % 10));
+        }
+        line_numbers.append(begin, end);
         line_numbers += '\n';
     }
-    auto code_tag = render_code(code);
+    return line_numbers;
+}
+
+// lines has to be the number of line ends in code plus one
+inline auto make_code_snippet(std::string code, std::size_t const lines)
+{
+    using namespace Si::html;
     return tags::div(
             tags::cl("sourcecodeSnippet"),
-            tags::pre(tags::cl("lineNumbers"), text(std::move(line_numbers))) +
-            tags::pre(std::move(code_tag)));
+            tags::pre(tags::cl("lineNumbers"), text(make_line_numbers(lines))) +
+            tags::pre(render_code(std::move(code))));
+}
+
+template <class StringLike>
+auto make_code_snippet(StringLike const &code)
+{
+    std::size_t const lines =
+            std::count(std::begin(code), std::end(code), '\n') + 1;
+    return make_code_snippet(std::string(std::begin(code), std::end(code)),
+                             lines);
+}
+
+// Like make_code_snippet, but the code has to outlive the element.
+inline auto make_code_snippet_view(boost::string_ref const code,
+                                   std::size_t const lines)
+{
+    using namespace Si::html;
+    return tags::div(
+            tags::cl("sourcecodeSnippet"),
+            tags::pre(tags::cl("lineNumbers"), text(make_line_numbers(lines))) +
+            tags::pre(render_code_view(code)));
+}
+
+// The code of a snippet the way it is shown on the page
+struct clean_snippet
+{
+    // Only set if the source contained tabs or carriage returns. Otherwise
+    // the source is shown as it is.
+    Si::optional<std::string> cleaned_code;
+    std::size_t lines;
+
+    boost::string_ref code(boost::string_ref const source) const
+    {
+        return cleaned_code ? boost::string_ref(*cleaned_code) : source;
+    }
+};
+
+// Expands tabs to four spaces, removes carriage returns and counts the lines
+// in a single pass over the source. The ordinary characters between the
+// special ones are copied as whole runs, and only once the first tab or
+// carriage return shows that a copy is needed at all.
+inline clean_snippet clean_snippet_source(boost::string_ref const source)
+{
+    clean_snippet result;
+    result.lines = 1;
+    char const *run_begin = source.begin();
+    for (char const *i = source.begin(); i != source.end(); ++i)
+    {
+        char const c = *i;
+        if (c == '\n')
+        {
+            ++result.lines;
+            continue;
+        }
+        if ((c != '\t') && (c != '\r'))
+        {
+            continue;
+        }
+        if (!result.cleaned_code)
+        {
+            result.cleaned_code = std::string();
+            // enough for a few tabs
+            result.cleaned_code->reserve(source.size() + 64);
+        }
+        result.cleaned_code->append(run_begin, i);
+        if (c == '\t')
+        {
+            result.cleaned_code->append(4, ' ');
+        }
+        run_begin = i + 1;
+    }
+    if (result.cleaned_code)
+    {
+        result.cleaned_code->append(run_begin, source.end());
+    }
+    return result;
 }
 
-auto snippet_from_file(ventura::absolute_path const &snippets_source_code,
-                       ventura::relative_path const &name)
+// Reads a file that the generator needs. Problems are thrown as
+// std::runtime_error so that they stop the generation of the page.
+inline std::vector<char>
+read_source_file(ventura::absolute_path const &full_name)
 {
-    ventura::absolute_path const full_name = snippets_source_code / name;
     Si::variant<std::vector<char>, boost::system::error_code,
     ventura::read_file_problem> read_result =
             ventura::read_file(ventura::safe_c_str(to_os_string(full_name)));
@@ -64,23 +165,37 @@ auto snippet_from_file(ventura::absolute_path const &snippets_source_code,
                                         "concurrently"));
                 }
             });
+    return content;
+}
 
-    std::string clean;
-    for (char c : content)
-    {
-        switch (c)
-        {
-            case '\t':
-                clean += "    ";
-                break;
-
-            case '\r':
-                break;
+// the HTML of the code snippet for the content of a snippet file
+inline std::string render_snippet_html(boost::string_ref const source)
+{
+    clean_snippet const clean = clean_snippet_source(source);
+    std::string html;
+    auto sink = Si::Sink<char, Si::success>::erase(
+            Si::make_container_sink(html));
+    make_code_snippet_view(clean.code(source), clean.lines).generate(sink);
+    return html;
+}
 
-            default:
-                clean += c;
-                break;
-        }
-    }
-    return make_code_snippet(std::move(clean));
-}
\ No newline at end of file
+// The element owns the content of the file, which is shown without being
+// copied unless it has to be cleaned.
+inline auto
+snippet_from_file(ventura::absolute_path const &snippets_source_code,
+                  ventura::relative_path const &name)
+{
+    std::vector<char> content = read_source_file(snippets_source_code / name);
+    clean_snippet clean = clean_snippet_source(
+            boost::string_ref(content.data(), content.size()));
+    return Si::html::dynamic([
+        content = std::move(content),
+        clean = std::move(clean)
+    ](Si::html::code_sink & sink)
+    {
+        make_code_snippet_view(
+                clean.code(boost::string_ref(content.data(), content.size())),
+                clean.lines)
+                .generate(sink);
+    });
+}
@@ -1,5 +1,7 @@
 #pragma once
+#include <functional>
 #include <silicium/html/tree.hpp>
+#include <silicium/sink/iterator_sink.hpp>
 
 namespace tags
 {
@@ -283,6 +285,47 @@ namespace tags
 		            address_without_protocol);
 	}
 
+	// The HTML of the prerendered subtree identified by Tag. render is only
+	// called the first time.
+	template <class Tag>
+	inline std::string const &
+	prerendered_html(std::function<std::string()> const &render)
+	{
+		static std::string const html = render();
+		return html;
+	}
+
+	// PSEUDO TAG: prerendered (a constant subtree rendered only once)
+	// make_element is called on the first use of Tag and the HTML it
+	// generates is remembered. Later generations copy it with a single append
+	// instead of walking and escaping the subtree again. The HTML is found
+	// by Tag alone, so every subtree needs a Tag type of its own:
+	//
+	// struct page_footer_tag;
+	// tags::prerendered<page_footer_tag>(make_page_footer)
+	//
+	// The subtree must not depend on anything that can change between the
+	// calls.
+	template <class Tag, class MakeElement>
+	inline auto prerendered(MakeElement const &make_element)
+	{
+		using namespace Si::html;
+		auto const render = [&make_element]()
+		{
+			std::string result;
+			auto sink = Si::Sink<char, Si::success>::erase(
+			    Si::make_container_sink(result));
+			make_element().generate(sink);
+			return result;
+		};
+		std::string const &html = prerendered_html<Tag>(render);
+		return dynamic([&html](code_sink &sink)
+		               {
+			               sink.append(Si::make_iterator_range(
+			                   html.data(), html.data() + html.size()));
+			           });
+	}
+
 	// PSEUDO ATTRIBUTE: anchor_attributes (emulates a jump mark on a page)
 	template <std::size_t N>
 	inline auto anchor_attributes(char const(&name)[N])
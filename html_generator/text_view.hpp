@@ -0,0 +1,196 @@
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+#include <silicium/html/tree.hpp>
+
+#if defined(__AVX2__)
+#define TYROXX_HAVE_AVX2 1
+#else
+#define TYROXX_HAVE_AVX2 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TYROXX_HAVE_SSE2 1
+#else
+#define TYROXX_HAVE_SSE2 0
+#endif
+
+#if TYROXX_HAVE_AVX2
+#include <immintrin.h>
+#elif TYROXX_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+inline bool needs_escaping(char const c)
+{
+	return (c == '&') || (c == '<') || (c == '>') || (c == '"') ||
+	       (c == '\'');
+}
+
+namespace
+{
+	namespace detail
+	{
+		inline char const *find_character_to_escape_scalar(char const *i,
+		                                                   char const *end)
+		{
+			for (; i != end; ++i)
+			{
+				if (needs_escaping(*i))
+				{
+					break;
+				}
+			}
+			return i;
+		}
+
+		inline unsigned lowest_set_bit(unsigned const mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+		}
+
+#if TYROXX_HAVE_SSE2
+		// one byte of the result is 0xff for every byte of chunk that has to
+		// be escaped
+		inline __m128i find_characters_to_escape(__m128i const chunk)
+		{
+			__m128i const ampersands =
+			    _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'));
+			__m128i const less = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<'));
+			__m128i const greater = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>'));
+			__m128i const quotes = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+			__m128i const apostrophes =
+			    _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\''));
+			return _mm_or_si128(
+			    _mm_or_si128(_mm_or_si128(ampersands, less),
+			                 _mm_or_si128(greater, quotes)),
+			    apostrophes);
+		}
+#endif
+
+#if TYROXX_HAVE_AVX2
+		inline __m256i find_characters_to_escape(__m256i const chunk)
+		{
+			__m256i const ampersands =
+			    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'));
+			__m256i const less =
+			    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('<'));
+			__m256i const greater =
+			    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('>'));
+			__m256i const quotes =
+			    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+			__m256i const apostrophes =
+			    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\''));
+			return _mm256_or_si256(
+			    _mm256_or_si256(_mm256_or_si256(ampersands, less),
+			                    _mm256_or_si256(greater, quotes)),
+			    apostrophes);
+		}
+#endif
+	}
+}
+
+// Returns the first character in [begin, end) that has to be escaped, or end.
+// Runs of text without such characters are skipped 32 (AVX2) or 16 (SSE2)
+// bytes at a time because they make up most of the text of a page.
+inline char const *find_character_to_escape(char const *begin,
+                                            char const *const end)
+{
+#if TYROXX_HAVE_AVX2
+	for (; (end - begin) >= 32; begin += 32)
+	{
+		__m256i const chunk =
+		    _mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin));
+		unsigned const mask = static_cast<unsigned>(_mm256_movemask_epi8(
+		    detail::find_characters_to_escape(chunk)));
+		if (mask != 0)
+		{
+			return begin + detail::lowest_set_bit(mask);
+		}
+	}
+#endif
+#if TYROXX_HAVE_SSE2
+	for (; (end - begin) >= 16; begin += 16)
+	{
+		__m128i const chunk =
+		    _mm_loadu_si128(reinterpret_cast<__m128i const *>(begin));
+		unsigned const mask = static_cast<unsigned>(
+		    _mm_movemask_epi8(detail::find_characters_to_escape(chunk)));
+		if (mask != 0)
+		{
+			return begin + detail::lowest_set_bit(mask);
+		}
+	}
+#endif
+	return detail::find_character_to_escape_scalar(begin, end);
+}
+
+// Writes content escaped the same way as Si::html::text, but without copying
+// the content into an element first. The text between the characters that
+// need escaping is appended in one piece.
+inline void write_escaped_text(Si::html::code_sink &sink,
+                               boost::string_ref const content)
+{
+	char const *unescaped_begin = content.begin();
+	for (;;)
+	{
+		char const *const i =
+		    find_character_to_escape(unescaped_begin, content.end());
+		sink.append(Si::make_iterator_range(unescaped_begin, i));
+		if (i == content.end())
+		{
+			break;
+		}
+		boost::string_ref entity;
+		switch (*i)
+		{
+		case '&':
+			entity = "&amp;";
+			break;
+		case '<':
+			entity = "&lt;";
+			break;
+		case '>':
+			entity = "&gt;";
+			break;
+		case '"':
+			entity = "&quot;";
+			break;
+		// only the apostrophe is left
+		default:
+			entity = "&apos;";
+			break;
+		}
+		sink.append(Si::make_iterator_range(entity.begin(), entity.end()));
+		unescaped_begin = i + 1;
+	}
+}
+
+// Writes content that is known not to need escaping, like tags and attributes
+// that are spelled out in the source code.
+inline void write_raw(Si::html::code_sink &sink,
+                      boost::string_ref const content)
+{
+	sink.append(Si::make_iterator_range(content.begin(), content.end()));
+}
+
+// Like Si::html::text, but refers to the content instead of owning a copy.
+// The content has to outlive the element.
+inline auto text_view(boost::string_ref const content)
+{
+	return Si::html::dynamic([content](Si::html::code_sink &sink)
+	                         {
+		                         write_escaped_text(sink, content);
+		                     });
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include "cpp_syntax_highlighting.hpp"
 #include "html_generator/snippets.h"
@@ -11,58 +12,117 @@ enum class markdown_types
 	inline_code
 };
 
+// content points into the bark_down source
 struct markdown_token
 {
-	std::string content;
+	boost::string_ref content;
 	markdown_types type;
 };
 
-template <class RandomAccessIterator>
-std::string find_next_paragraph(RandomAccessIterator begin,
-                                RandomAccessIterator end)
+// the first backtick in content at or after from, or the size of content
+inline std::size_t find_backtick(boost::string_ref const content,
+                                 std::size_t const from)
 {
-	if (begin == end)
+	if (from >= content.size())
 	{
-		return "";
+		return content.size();
 	}
+	std::size_t const found = content.substr(from).find('`');
+	return (found == boost::string_ref::npos) ? content.size()
+	                                          : (from + found);
+}
+
+// The length of the line end at position in text: 2 for "\r\n", 1 for a
+// single '\n' or '\r' and 0 if there is no line end. Files checked out
+// on Windows end their lines with "\r\n".
+inline std::size_t line_end_length(boost::string_ref const text,
+                                   std::size_t const position)
+{
+	if (!is_line_end(text[position]))
+	{
+		return 0;
+	}
+	bool const is_crlf = (text[position] == '\r') &&
+	                     ((position + 1) < text.size()) &&
+	                     (text[position + 1] == '\n');
+	return is_crlf ? 2 : 1;
+}
+
+// A paragraph ends before the second of two consecutive line ends. The
+// result is empty at the end of the source.
+inline boost::string_ref find_next_paragraph(boost::string_ref const source)
+{
+	if (source.empty())
+	{
+		return source;
+	}
+	// the line end that ended the previous paragraph belongs to this one
+	std::size_t end =
+	    (std::max)(line_end_length(source, 0), std::size_t(1));
 	bool is_new_line = false;
-	return std::string(begin,
-	                   std::find_if(begin + 1, end, [&](char c)
-	                                {
-		                                if (is_new_line && is_line_end(c))
-		                                {
-			                                return true;
-		                                }
-		                                is_new_line = is_line_end(c);
-		                                return false;
-		                            }));
+	while (end < source.size())
+	{
+		std::size_t const line_end = line_end_length(source, end);
+		if (line_end == 0)
+		{
+			is_new_line = false;
+			++end;
+			continue;
+		}
+		if (is_new_line)
+		{
+			break;
+		}
+		is_new_line = true;
+		end += line_end;
+	}
+	return source.substr(0, end);
 }
 
-template <class RandomAccessIterator>
-markdown_token find_next_mark_down_token(RandomAccessIterator &begin,
-                                         RandomAccessIterator end)
+// The content of inline code is what is between the backticks. Inline code
+// without a closing backtick extends to the end of the paragraph.
+inline markdown_token find_next_mark_down_token(boost::string_ref const rest)
 {
-	if (begin == end)
+	if (rest.empty())
 	{
 		return {"", markdown_types::eof};
 	}
-	if (*begin == '`')
+	if (rest.front() == '`')
 	{
-		begin += 1;
-		return {std::string(begin, std::find_if(begin + 1, end,
-		                                        [](char c)
-		                                        {
-			                                        return c == '`';
-			                                    })),
+		boost::string_ref const code = rest.substr(1);
+		return {code.substr(0, find_backtick(code, 1)),
 		        markdown_types::inline_code};
 	}
-	return {std::string(begin, std::find_if(begin + 1, end,
-	                                        [](char c)
-	                                        {
-		                                        return c == '`';
+	return {rest.substr(0, find_backtick(rest, 1)), markdown_types::text};
+}
+
+inline void write_paragraph(Si::html::code_sink &sink,
+                            boost::string_ref rest)
+{
+	for (;;)
+	{
+		markdown_token const token = find_next_mark_down_token(rest);
+		switch (token.type)
+		{
+		case markdown_types::eof:
+			return;
 
-		                                    })),
-	        markdown_types::text};
+		case markdown_types::inline_code:
+			inline_code_view(token.content).generate(sink);
+			// the backticks
+			rest.remove_prefix(
+			    (std::min)(rest.size(), token.content.size() + 2));
+			break;
+
+		case markdown_types::text:
+			if (line_end_length(token.content, 0) != token.content.size())
+			{
+				write_escaped_text(sink, token.content);
+			}
+			rest.remove_prefix(token.content.size());
+			break;
+		}
+	}
 }
 
 inline auto compile_paragraph(std::string source)
@@ -70,58 +130,162 @@ inline auto compile_paragraph(std::string source)
 	return Si::html::dynamic([source =
 	                              std::move(source)](Si::html::code_sink & sink)
 	                         {
-		                         auto i = source.begin();
-		                         for (;;)
-		                         {
-			                         markdown_token token =
-			                             find_next_mark_down_token(
-			                                 i, source.end());
-			                         switch (token.type)
-			                         {
-			                         case markdown_types::eof:
-				                         return;
-
-			                         case markdown_types::inline_code:
-				                         inline_code(token.content)
-				                             .generate(sink);
-				                         i += 1;
-				                         break;
-
-			                         case markdown_types::text:
-				                         if ((token.content.size() != 1) ||
-				                             !is_line_end(token.content[0]))
-				                         {
-					                         Si::html::text(token.content)
-					                             .generate(sink);
-				                         }
-				                         break;
-			                         }
-			                         i += token.content.size();
-		                         }
+		                         write_paragraph(sink, source);
 		                     });
 }
 
+inline boost::string_ref trim_spaces(boost::string_ref text)
+{
+	while (!text.empty() && ((text.front() == ' ') || (text.front() == '\t')))
+	{
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && ((text.back() == ' ') || (text.back() == '\t')))
+	{
+		text.remove_suffix(1);
+	}
+	return text;
+}
+
+// Removes the next line that is not empty from text and returns it without
+// its line end. Returns an empty view if there is no such line.
+inline boost::string_ref take_line(boost::string_ref &text)
+{
+	while (!text.empty())
+	{
+		std::size_t const end = (std::min)(text.find('\n'), text.size());
+		boost::string_ref line = text.substr(0, end);
+		text.remove_prefix((std::min)(end + 1, text.size()));
+		if (!line.empty() && (line.back() == '\r'))
+		{
+			line.remove_suffix(1);
+		}
+		if (!line.empty())
+		{
+			return line;
+		}
+	}
+	return boost::string_ref();
+}
+
+// A paragraph is a table if every line starts with '|' and the second line
+// separates the header from the body:
+//
+// | Type | Purpose |
+// |------|---------|
+// | `std::size_t` | unsigned size of objects in memory |
+inline bool is_table(boost::string_ref paragraph)
+{
+	std::size_t line_count = 0;
+	for (;;)
+	{
+		boost::string_ref const line = take_line(paragraph);
+		if (line.empty())
+		{
+			return (line_count >= 2);
+		}
+		if (!trim_spaces(line).starts_with('|'))
+		{
+			return false;
+		}
+		if ((line_count == 1) &&
+		    !std::all_of(line.begin(), line.end(), [](char const c)
+		                 {
+			                 return (c == '|') || (c == '-') || (c == ':') ||
+			                        (c == ' ') || (c == '\t');
+			             }))
+		{
+			return false;
+		}
+		++line_count;
+	}
+}
+
+// "| a | `b` |" has the cells "a" and "`b`".
+inline void write_table_cells(Si::html::code_sink &sink, boost::string_ref row,
+                              boost::string_ref const cell_tag)
+{
+	row = trim_spaces(row);
+	if (row.starts_with('|'))
+	{
+		row.remove_prefix(1);
+	}
+	if (row.ends_with('|'))
+	{
+		row.remove_suffix(1);
+	}
+	for (;;)
+	{
+		std::size_t const separator = row.find('|');
+		write_raw(sink, "<");
+		write_raw(sink, cell_tag);
+		write_raw(sink, ">");
+		write_paragraph(sink, trim_spaces(row.substr(0, separator)));
+		write_raw(sink, "</");
+		write_raw(sink, cell_tag);
+		write_raw(sink, ">");
+		if (separator == boost::string_ref::npos)
+		{
+			return;
+		}
+		row.remove_prefix(separator + 1);
+	}
+}
+
+// The same structure as tags::table(header_row(...) + row(...) + ...).
+// paragraph has to be a table according to is_table.
+inline void write_table(Si::html::code_sink &sink,
+                        boost::string_ref paragraph)
+{
+	write_raw(sink, "<table><thead><tr>");
+	write_table_cells(sink, take_line(paragraph), "th");
+	write_raw(sink, "</tr></thead>");
+	// the separator
+	take_line(paragraph);
+	for (;;)
+	{
+		boost::string_ref const row = take_line(paragraph);
+		if (row.empty())
+		{
+			break;
+		}
+		write_raw(sink, "<tr>");
+		write_table_cells(sink, row, "td");
+		write_raw(sink, "</tr>");
+	}
+	write_raw(sink, "</table>");
+}
+
+// Walks the source once and writes the HTML while doing so. Nothing is
+// copied out of the source, so the memory needed does not grow with the
+// size of the document.
+inline void write_bark_down(Si::html::code_sink &sink,
+                            boost::string_ref rest)
+{
+	for (;;)
+	{
+		boost::string_ref const paragraph = find_next_paragraph(rest);
+		if (paragraph.empty())
+		{
+			return;
+		}
+		rest.remove_prefix(paragraph.size());
+		if (is_table(paragraph))
+		{
+			write_table(sink, paragraph);
+			continue;
+		}
+		write_raw(sink, "<p>");
+		write_paragraph(sink, paragraph);
+		write_raw(sink, "</p>");
+	}
+}
+
 inline auto compile(std::string source)
 {
 	return Si::html::dynamic([source =
 	                              std::move(source)](Si::html::code_sink & sink)
 	                         {
-		                         auto i = source.begin();
-		                         for (;;)
-		                         {
-			                         std::string paragraph =
-			                             find_next_paragraph(i, source.end());
-			                         if (paragraph.size() == 0)
-			                         {
-				                         return;
-			                         }
-
-			                         i += paragraph.size();
-			                         Si::html::tag("p",
-			                                       compile_paragraph(
-			                                           std::move(paragraph)))
-			                             .generate(sink);
-		                         }
-
+		                         write_bark_down(sink, source);
 		                     });
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "html_generator/tags.hpp"
+#include "html_generator/text_view.hpp"
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 inline bool is_brace(char const c)
@@ -27,12 +30,25 @@ enum class token_type
 	other
 };
 
+// content points into the source code that was tokenized
 struct token
 {
-	std::string content;
+	boost::string_ref content;
 	token_type type;
 };
 
+// The iterators have to point into contiguous memory like std::string does.
+template <class RandomAccessIterator>
+boost::string_ref make_string_ref(RandomAccessIterator begin,
+                                  RandomAccessIterator end)
+{
+	if (begin == end)
+	{
+		return boost::string_ref();
+	}
+	return boost::string_ref(&*begin, static_cast<std::size_t>(end - begin));
+}
+
 template <class RandomAccessIterator>
 token find_next_token(RandomAccessIterator begin, RandomAccessIterator end)
 {
@@ -45,7 +61,7 @@ token find_next_token(RandomAccessIterator begin, RandomAccessIterator end)
 	{
 		bool hasColon = (*begin == ':');
 		size_t colonCount = (*begin == ':') ? 1 : 0;
-		std::string content = std::string(
+		boost::string_ref const content = make_string_ref(
 		    begin, std::find_if(begin + 1, end, [&](char c)
 		                        {
 			                        if (c == ':')
@@ -72,17 +88,17 @@ token find_next_token(RandomAccessIterator begin, RandomAccessIterator end)
 	// Detecting whitespaces
 	if (!isprint(*begin))
 	{
-		return {std::string(begin, std::find_if(begin + 1, end,
-		                                        [](char c)
-		                                        {
-			                                        return isprint(c);
-			                                    })),
+		return {make_string_ref(begin, std::find_if(begin + 1, end,
+		                                            [](char c)
+		                                            {
+			                                            return isprint(c);
+			                                        })),
 		        token_type::space};
 	}
 	// Detecting braces
 	if (is_brace(*begin))
 	{
-		return {std::string(begin, begin + 1), token_type::brace};
+		return {make_string_ref(begin, begin + 1), token_type::brace};
 	}
 	// Detecting escaped characters
 	if (*begin == '"' || *begin == '\'')
@@ -108,17 +124,17 @@ token find_next_token(RandomAccessIterator begin, RandomAccessIterator end)
 		{
 			throw std::invalid_argument("Number of quotes must be even");
 		}
-		return {std::string(begin, end_index + 1), token_type::string};
+		return {make_string_ref(begin, end_index + 1), token_type::string};
 	}
 	// Detecting pre processor directives
 	if (*begin == '#')
 	{
-		return {std::string(begin, std::find_if(begin + 1, end,
-		                                        [](char c)
-		                                        {
-			                                        return is_line_end(c) ||
-			                                               c == '"';
-			                                    })),
+		return {make_string_ref(begin, std::find_if(begin + 1, end,
+		                                            [](char c)
+		                                            {
+			                                            return is_line_end(c) ||
+			                                                   c == '"';
+			                                        })),
 		        token_type::preprocessor};
 	}
 	// Detecting comments
@@ -128,141 +144,187 @@ token find_next_token(RandomAccessIterator begin, RandomAccessIterator end)
 		// Single line comments
 		if (comment_type == '/')
 		{
-			return {
-			    std::string(begin, std::find_if(begin + 1, end, is_line_end)),
-			    token_type::comment};
+			return {make_string_ref(
+			            begin, std::find_if(begin + 1, end, is_line_end)),
+			        token_type::comment};
 		}
 		// Multiple line comments
 		if (comment_type == '*')
 		{
 			bool is_end = true;
-			return {std::string(begin, std::find_if(begin + 1, end,
-			                                        [&](char c)
-			                                        {
-				                                        if (is_end && c == '/')
-				                                        {
-					                                        return true;
-				                                        }
-				                                        is_end = (c == '*');
-				                                        return false;
-				                                    }) +
-			                               1),
+			RandomAccessIterator const last_slash =
+			    std::find_if(begin + 1, end, [&](char c)
+			                 {
+				                 if (is_end && c == '/')
+				                 {
+					                 return true;
+				                 }
+				                 is_end = (c == '*');
+				                 return false;
+				             });
+			// an unterminated comment extends to the end of the code
+			return {make_string_ref(begin, (last_slash == end)
+			                                   ? end
+			                                   : (last_slash + 1)),
 			        token_type::comment};
 		}
 	}
-	return {std::string(begin, std::find_if(begin + 1, end,
-	                                        [](char c)
-	                                        {
-		                                        return isalnum(c) || c == '"' ||
-		                                               c == ':' || c == '\'' ||
-		                                               c == '/';
-		                                    })),
-	        token_type::other};
+	RandomAccessIterator const other_end =
+	    std::find_if(begin + 1, end, [](char c)
+	                 {
+		                 return isalnum(c) || c == '"' || c == ':' ||
+		                        c == '\'' || c == '/';
+		             });
+	return {make_string_ref(begin, other_end), token_type::other};
 }
 
-inline auto render_code_raw(std::string code)
+// keywords have to be sorted and exactly as long as the identifier
+template <std::size_t N>
+bool is_in_sorted_keywords(char const *const (&keywords)[N],
+                           boost::string_ref const identifier)
 {
-	using namespace Si::html;
-	return dynamic([code = std::move(code)](code_sink & sink)
-	               {
-		               static const boost::string_ref keywords[] = {
-		                   "alignas",      "alignof",
-		                   "and",          "and_eq",
-		                   "asm",          "auto",
-		                   "bitand",       "bitor",
-		                   "bool",         "break",
-		                   "case",         "catch",
-		                   "char",         "char16_t",
-		                   "char32_t",     "class",
-		                   "compl",        "const",
-		                   "constexpr",    "const_cast",
-		                   "continue",     "decltype",
-		                   "default",      "delete",
-		                   "do",           "double",
-		                   "dynamic_cast", "else",
-		                   "enum",         "explicit",
-		                   "export",       "extern",
-		                   "false",        "float",
-		                   "for",          "friend",
-		                   "goto",         "if",
-		                   "inline",       "int",
-		                   "long",         "mutable",
-		                   "namespace",    "new",
-		                   "noexcept",     "not",
-		                   "not_eq",       "nullptr",
-		                   "operator",     "or",
-		                   "or_eq",        "private",
-		                   "protected",    "public",
-		                   "register",     "reinterpret_cast",
-		                   "return",       "short",
-		                   "signed",       "sizeof",
-		                   "static",       "static_assert",
-		                   "static_cast",  "struct",
-		                   "switch",       "template",
-		                   "this",         "thread_local",
-		                   "throw",        "true",
-		                   "try",          "typedef",
-		                   "typeid",       "typename",
-		                   "union",        "unsigned",
-		                   "using",        "virtual",
-		                   "void",         "volatile",
-		                   "wchar_t",      "while",
-		                   "xor",          "xor_eq",
-		                   "override",     "final"};
-		               auto i = code.begin();
-		               for (;;)
-		               {
-			               token t = find_next_token(i, code.end());
-			               switch (t.type)
-			               {
-			               case token_type::eof:
-				               return;
+	char const *const *const found = std::lower_bound(
+	    std::begin(keywords), std::end(keywords), identifier,
+	    [](char const *keyword, boost::string_ref const searched)
+	    {
+		    return std::memcmp(keyword, searched.data(), searched.size()) < 0;
+		});
+	return (found != std::end(keywords)) &&
+	       (std::memcmp(*found, identifier.data(), identifier.size()) == 0);
+}
 
-			               case token_type::preprocessor:
-				               tags::span(attribute("class", "preprocessor"),
-				                          text(t.content))
-				                   .generate(sink);
-				               break;
+// The keywords are grouped by length and sorted within each group. An
+// identifier is only compared with the few keywords of its own length that a
+// binary search visits instead of with every keyword.
+inline bool is_keyword(boost::string_ref const identifier)
+{
+	static char const *const length_2[] = {"do", "if", "or"};
+	static char const *const length_3[] = {"and", "asm", "for", "int",
+	                                       "new", "not", "try", "xor"};
+	static char const *const length_4[] = {"auto", "bool", "case", "char",
+	                                       "else", "enum", "goto", "long",
+	                                       "this", "true", "void"};
+	static char const *const length_5[] = {
+	    "bitor", "break", "catch", "class", "compl", "const", "false", "final",
+	    "float", "or_eq", "short", "throw", "union", "using", "while"};
+	static char const *const length_6[] = {
+	    "and_eq", "bitand", "delete", "double", "export", "extern",
+	    "friend", "inline", "not_eq", "public", "return", "signed",
+	    "sizeof", "static", "struct", "switch", "typeid", "xor_eq"};
+	static char const *const length_7[] = {
+	    "alignas", "alignof", "default", "mutable", "nullptr",
+	    "private", "typedef", "virtual", "wchar_t"};
+	static char const *const length_8[] = {
+	    "char16_t", "char32_t", "continue", "decltype", "explicit",
+	    "noexcept", "operator", "override", "register", "template",
+	    "typename", "unsigned", "volatile"};
+	static char const *const length_9[] = {"constexpr", "namespace",
+	                                       "protected"};
+	static char const *const length_10[] = {"const_cast"};
+	static char const *const length_11[] = {"static_cast"};
+	static char const *const length_12[] = {"dynamic_cast", "thread_local"};
+	static char const *const length_13[] = {"static_assert"};
+	static char const *const length_16[] = {"reinterpret_cast"};
 
-			               case token_type::comment:
-				               tags::span(attribute("class", "comment"),
-				                          text(t.content))
-				                   .generate(sink);
-				               break;
+	switch (identifier.size())
+	{
+	case 2:
+		return is_in_sorted_keywords(length_2, identifier);
+	case 3:
+		return is_in_sorted_keywords(length_3, identifier);
+	case 4:
+		return is_in_sorted_keywords(length_4, identifier);
+	case 5:
+		return is_in_sorted_keywords(length_5, identifier);
+	case 6:
+		return is_in_sorted_keywords(length_6, identifier);
+	case 7:
+		return is_in_sorted_keywords(length_7, identifier);
+	case 8:
+		return is_in_sorted_keywords(length_8, identifier);
+	case 9:
+		return is_in_sorted_keywords(length_9, identifier);
+	case 10:
+		return is_in_sorted_keywords(length_10, identifier);
+	case 11:
+		return is_in_sorted_keywords(length_11, identifier);
+	case 12:
+		return is_in_sorted_keywords(length_12, identifier);
+	case 13:
+		return is_in_sorted_keywords(length_13, identifier);
+	case 16:
+		return is_in_sorted_keywords(length_16, identifier);
+	default:
+		return false;
+	}
+}
 
-			               case token_type::string:
-				               tags::span(attribute("class", "stringLiteral"),
-				                          text(t.content))
-				                   .generate(sink);
-				               break;
+inline void write_highlighted_span(Si::html::code_sink &sink,
+                                   boost::string_ref const css_class,
+                                   boost::string_ref const content)
+{
+	write_raw(sink, "<span class=\"");
+	write_raw(sink, css_class);
+	write_raw(sink, "\">");
+	write_escaped_text(sink, content);
+	write_raw(sink, "</span>");
+}
 
-			               case token_type::identifier:
-				               if (std::find(std::begin(keywords),
-				                             std::end(keywords),
-				                             t.content) != std::end(keywords))
-				               {
-					               tags::span(attribute("class", "keyword"),
-					                          text(t.content))
-					                   .generate(sink);
-				               }
-				               else
-				               {
-					               text(t.content).generate(sink);
-				               }
-				               break;
+// The tokens are views into the code and are written to the sink directly,
+// so highlighting does not allocate anything per token.
+inline void write_highlighted_code(Si::html::code_sink &sink,
+                                   boost::string_ref const code)
+{
+	auto i = code.begin();
+	for (;;)
+	{
+		token const t = find_next_token(i, code.end());
+		switch (t.type)
+		{
+		case token_type::eof:
+			return;
+
+		case token_type::preprocessor:
+			write_highlighted_span(sink, "preprocessor", t.content);
+			break;
+
+		case token_type::comment:
+			write_highlighted_span(sink, "comment", t.content);
+			break;
+
+		case token_type::string:
+			write_highlighted_span(sink, "stringLiteral", t.content);
+			break;
+
+		case token_type::identifier:
+			if (is_keyword(t.content))
+			{
+				write_highlighted_span(sink, "keyword", t.content);
+			}
+			else
+			{
+				write_escaped_text(sink, t.content);
+			}
+			break;
+
+		case token_type::double_colon:
+			write_highlighted_span(sink, "names", t.content);
+			break;
+		case token_type::space:
+		case token_type::other:
+		case token_type::brace:
+			write_escaped_text(sink, t.content);
+		}
+		i += t.content.size();
+	}
+}
 
-			               case token_type::double_colon:
-				               tags::span(attribute("class", "names"),
-				                          text(t.content))
-				                   .generate(sink);
-				               break;
-			               case token_type::space:
-			               case token_type::other:
-			               case token_type::brace:
-				               text(t.content).generate(sink);
-			               }
-			               i += t.content.size();
-		               }
+inline auto render_code_raw(std::string code)
+{
+	using namespace Si::html;
+	return dynamic([code = std::move(code)](code_sink & sink)
+	               {
+		               write_highlighted_code(sink, code);
 		           });
 }
 
@@ -271,3 +333,13 @@ inline auto render_code(std::string code)
 	using namespace Si::html;
 	return tag("code", render_code_raw(std::move(code)));
 }
+
+// Like render_code, but the code has to outlive the element.
+inline auto render_code_view(boost::string_ref const code)
+{
+	using namespace Si::html;
+	return tag("code", dynamic([code](code_sink &sink)
+	                           {
+		                           write_highlighted_code(sink, code);
+		                       }));
+}
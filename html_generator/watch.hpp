@@ -0,0 +1,119 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <boost/system/error_code.hpp>
+
+#ifdef __linux__
+#define TYROXX_HAVE_INOTIFY 1
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#define TYROXX_HAVE_INOTIFY 0
+#endif
+
+#if TYROXX_HAVE_INOTIFY
+// Waits for changes to the files in a set of directories. Subdirectories are
+// not watched.
+class directory_watcher
+{
+public:
+	directory_watcher()
+	    : m_inotify(inotify_init1(IN_CLOEXEC))
+	{
+	}
+
+	~directory_watcher()
+	{
+		if (m_inotify >= 0)
+		{
+			close(m_inotify);
+		}
+	}
+
+	directory_watcher(directory_watcher const &) = delete;
+	directory_watcher &operator=(directory_watcher const &) = delete;
+
+	boost::system::error_code add(boost::filesystem::path const &directory)
+	{
+		if (m_inotify < 0)
+		{
+			return last_error();
+		}
+		// Editors often save by writing a new file and renaming it over the
+		// old one, so the moves count as much as the writes.
+		if (inotify_add_watch(m_inotify, directory.c_str(),
+		                      IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+		                          IN_MOVED_FROM | IN_MOVED_TO) < 0)
+		{
+			return last_error();
+		}
+		return {};
+	}
+
+	// Blocks until something changed and then until nothing changed for
+	// quiet_milliseconds. Saving in an editor or checking out a commit
+	// changes several files at once, which should only be reported once.
+	boost::system::error_code wait_for_change(int const quiet_milliseconds)
+	{
+		boost::system::error_code ec = read_events();
+		if (!!ec)
+		{
+			return ec;
+		}
+		for (;;)
+		{
+			pollfd readable = {};
+			readable.fd = m_inotify;
+			readable.events = POLLIN;
+			int const ready = poll(&readable, 1, quiet_milliseconds);
+			if (ready < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return last_error();
+			}
+			if (ready == 0)
+			{
+				return {};
+			}
+			ec = read_events();
+			if (!!ec)
+			{
+				return ec;
+			}
+		}
+	}
+
+private:
+	int m_inotify;
+
+	static boost::system::error_code last_error()
+	{
+		return boost::system::error_code(errno,
+		                                 boost::system::system_category());
+	}
+
+	// Reads and discards the pending events. Which file changed does not
+	// matter because the build manifest finds the outdated outputs.
+	boost::system::error_code read_events()
+	{
+		alignas(inotify_event) char events[4096];
+		for (;;)
+		{
+			ssize_t const read_bytes = read(m_inotify, events, sizeof(events));
+			if (read_bytes >= 0)
+			{
+				return {};
+			}
+			if (errno != EINTR)
+			{
+				return last_error();
+			}
+		}
+	}
+};
+#endif
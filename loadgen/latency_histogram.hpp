@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <boost/cstdint.hpp>
+#include <chrono>
+#include <cstddef>
+
+// Counts latencies in buckets whose width grows with the latency, so that
+// every recorded value is off by at most 1/16 while a few kilobytes cover
+// everything from nanoseconds to centuries. Percentiles are reported as the
+// largest value of their bucket, so they never look better than measured.
+class latency_histogram
+{
+public:
+	typedef std::chrono::nanoseconds duration;
+
+	latency_histogram()
+	    : m_count(0)
+	    , m_max(0)
+	{
+		m_buckets.fill(0);
+	}
+
+	void record(duration const latency)
+	{
+		boost::uint64_t const value =
+		    (latency.count() > 0)
+		        ? static_cast<boost::uint64_t>(latency.count())
+		        : 0;
+		++m_buckets[bucket_index(value)];
+		++m_count;
+		if (value > m_max)
+		{
+			m_max = value;
+		}
+	}
+
+	void add(latency_histogram const &other)
+	{
+		for (std::size_t i = 0; i < m_buckets.size(); ++i)
+		{
+			m_buckets[i] += other.m_buckets[i];
+		}
+		m_count += other.m_count;
+		if (other.m_max > m_max)
+		{
+			m_max = other.m_max;
+		}
+	}
+
+	boost::uint64_t count() const
+	{
+		return m_count;
+	}
+
+	duration max() const
+	{
+		return duration(static_cast<duration::rep>(m_max));
+	}
+
+	// The latency that the given fraction of the requests did not exceed,
+	// for example 0.99 for p99. Returns zero if nothing was recorded.
+	duration percentile(double const fraction) const
+	{
+		if (m_count == 0)
+		{
+			return duration(0);
+		}
+		double const wanted = fraction * static_cast<double>(m_count);
+		boost::uint64_t seen = 0;
+		for (std::size_t i = 0; i < m_buckets.size(); ++i)
+		{
+			seen += m_buckets[i];
+			if ((seen > 0) && (static_cast<double>(seen) >= wanted))
+			{
+				boost::uint64_t const largest =
+				    (i + 1 < m_buckets.size())
+				        ? (smallest_value_of_bucket(i + 1) - 1)
+				        : m_max;
+				return duration(static_cast<duration::rep>(
+				    (largest < m_max) ? largest : m_max));
+			}
+		}
+		return max();
+	}
+
+private:
+	enum
+	{
+		// each power of two is split into this many buckets
+		sub_bucket_bits = 4,
+		sub_bucket_count = 1 << sub_bucket_bits,
+		bucket_count = sub_bucket_count * (64 - sub_bucket_bits + 1)
+	};
+
+	std::array<boost::uint64_t, bucket_count> m_buckets;
+	boost::uint64_t m_count;
+	boost::uint64_t m_max;
+
+	static unsigned highest_bit(boost::uint64_t value)
+	{
+		unsigned bit = 0;
+		while (value > 1)
+		{
+			value >>= 1;
+			++bit;
+		}
+		return bit;
+	}
+
+	static std::size_t bucket_index(boost::uint64_t const value)
+	{
+		if (value < sub_bucket_count)
+		{
+			return static_cast<std::size_t>(value);
+		}
+		unsigned const exponent = highest_bit(value);
+		unsigned const shift = exponent - sub_bucket_bits;
+		std::size_t const sub_bucket =
+		    static_cast<std::size_t>(value >> shift) - sub_bucket_count;
+		return (shift + 1) * sub_bucket_count + sub_bucket;
+	}
+
+	static boost::uint64_t smallest_value_of_bucket(std::size_t const index)
+	{
+		if (index < sub_bucket_count)
+		{
+			return index;
+		}
+		std::size_t const shift = (index / sub_bucket_count) - 1;
+		boost::uint64_t const sub_bucket = index % sub_bucket_count;
+		return (sub_bucket_count + sub_bucket) << shift;
+	}
+};
@@ -0,0 +1,394 @@
+#include <atomic>
+#include <beast/core/streambuf.hpp>
+#include <beast/http/read.hpp>
+#include <beast/http/string_body.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/program_options.hpp>
+#include <html_generator/server/error_counters.hpp>
+#include <iomanip>
+#include <iostream>
+#include <loadgen/latency_histogram.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Measures the server of html_generator --serve. Every connection sends one
+// request after the other over the same keep-alive connection and goes round
+// the URLs. A connection that the server closes is opened again. Requests
+// are only counted after the warm-up, so that the caches of the server are
+// filled when the measurement starts.
+//
+// usage: loadgen --port 8080 [--connections 64] [--duration 10] [url...]
+
+namespace
+{
+	typedef std::chrono::steady_clock clock;
+
+	struct load_test
+	{
+		boost::asio::ip::tcp::endpoint server;
+		// complete serialized requests, one for each URL
+		std::vector<std::string> requests;
+		clock::time_point measure_from;
+		clock::time_point measure_until;
+
+		// A server that does not respond anymore must not keep the test
+		// running forever. The last connection to finish cancels this.
+		boost::asio::steady_timer give_up;
+		std::atomic<std::size_t> running_connections;
+
+		explicit load_test(boost::asio::io_service &io)
+		    : give_up(io)
+		    , running_connections(0)
+		{
+		}
+	};
+
+	struct load_connection
+	{
+		load_test &test;
+		boost::asio::ip::tcp::socket socket;
+		beast::streambuf receive_buffer;
+		beast::http::response<beast::http::string_body> response;
+		// the request that is being sent or waits for its response
+		std::size_t next_request;
+		clock::time_point sent_at;
+		// reconnects since the last response
+		std::size_t retries;
+
+		latency_histogram latencies;
+		std::size_t failed_connections;
+		std::size_t error_responses;
+		// how often the server closed the connection
+		std::size_t reconnects;
+
+		load_connection(boost::asio::io_service &io, load_test &test,
+		                std::size_t const first_request)
+		    : test(test)
+		    , socket(io)
+		    , next_request(first_request)
+		    , retries(0)
+		    , failed_connections(0)
+		    , error_responses(0)
+		    , reconnects(0)
+		{
+		}
+	};
+
+	void finish(load_connection &connection)
+	{
+		if (--connection.test.running_connections == 0)
+		{
+			connection.test.give_up.cancel();
+		}
+	}
+
+	void fail(load_connection &connection, boost::system::error_code const ec)
+	{
+		++connection.failed_connections;
+		std::cerr << "Connection failed: " << ec.message() << '\n';
+		boost::system::error_code ignored;
+		connection.socket.close(ignored);
+		finish(connection);
+	}
+
+	void send_request(load_connection &connection);
+
+	void connect(load_connection &connection)
+	{
+		connection.socket.async_connect(
+		    connection.test.server,
+		    [&connection](boost::system::error_code const ec)
+		    {
+			    if (!!ec)
+			    {
+				    fail(connection, ec);
+				    return;
+			    }
+			    send_request(connection);
+			});
+	}
+
+	// A keep-alive connection may be closed by the server at any time, for
+	// example after its idle timeout. That is no failure. The request that
+	// was in flight is sent again on a new connection.
+	void reconnect(load_connection &connection)
+	{
+		++connection.reconnects;
+		boost::system::error_code ignored;
+		connection.socket.close(ignored);
+		connection.receive_buffer.consume(connection.receive_buffer.size());
+		connect(connection);
+	}
+
+	// A server that closes every connection before it responds is broken.
+	std::size_t const max_retries = 3;
+
+	void handle_error(load_connection &connection,
+	                  boost::system::error_code const ec)
+	{
+		if (is_disconnect(ec) && (connection.retries < max_retries))
+		{
+			++connection.retries;
+			reconnect(connection);
+			return;
+		}
+		fail(connection, ec);
+	}
+
+	void receive_response(load_connection &connection);
+
+	void send_request(load_connection &connection)
+	{
+		clock::time_point const now = clock::now();
+		if (now >= connection.test.measure_until)
+		{
+			boost::system::error_code ignored;
+			connection.socket.shutdown(
+			    boost::asio::ip::tcp::socket::shutdown_both, ignored);
+			finish(connection);
+			return;
+		}
+		std::string const &request =
+		    connection.test.requests[connection.next_request];
+		connection.sent_at = now;
+		boost::asio::async_write(
+		    connection.socket, boost::asio::buffer(request),
+		    [&connection](boost::system::error_code const ec, std::size_t)
+		    {
+			    if (!!ec)
+			    {
+				    handle_error(connection, ec);
+				    return;
+			    }
+			    receive_response(connection);
+			});
+	}
+
+	void receive_response(load_connection &connection)
+	{
+		connection.response =
+		    beast::http::response<beast::http::string_body>();
+		beast::http::async_read(
+		    connection.socket, connection.receive_buffer, connection.response,
+		    [&connection](boost::system::error_code const ec)
+		    {
+			    if (!!ec)
+			    {
+				    handle_error(connection, ec);
+				    return;
+			    }
+			    connection.next_request = (connection.next_request + 1) %
+			                              connection.test.requests.size();
+			    connection.retries = 0;
+			    clock::time_point const now = clock::now();
+			    if (connection.sent_at >= connection.test.measure_from)
+			    {
+				    connection.latencies.record(now - connection.sent_at);
+				    if (connection.response.status >= 400)
+				    {
+					    ++connection.error_responses;
+				    }
+			    }
+			    if (!beast::http::is_keep_alive(connection.response))
+			    {
+				    // The response was fine, but the server does not want
+				    // another request on this connection. The time it takes
+				    // to connect again is not part of any latency.
+				    reconnect(connection);
+				    return;
+			    }
+			    send_request(connection);
+			});
+	}
+
+	std::string serialize_request(std::string const &host,
+	                              std::string const &url,
+	                              std::string const &accept_encoding)
+	{
+		std::string request = "GET " + url + " HTTP/1.1\r\n";
+		request += "Host: " + host + "\r\n";
+		if (!accept_encoding.empty())
+		{
+			request += "Accept-Encoding: " + accept_encoding + "\r\n";
+		}
+		request += "\r\n";
+		return request;
+	}
+
+	double to_milliseconds(latency_histogram::duration const latency)
+	{
+		return std::chrono::duration<double, std::milli>(latency).count();
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	std::string host = "127.0.0.1";
+	boost::uint16_t port = 0;
+	std::size_t connection_count = 64;
+	unsigned duration_seconds = 10;
+	unsigned warm_up_seconds = 1;
+	unsigned thread_count = 1;
+	std::string accept_encoding = "gzip";
+	std::vector<std::string> urls;
+
+	boost::program_options::options_description desc("Allowed options");
+	desc.add_options()("help", "produce help message")(
+	    "host", boost::program_options::value(&host),
+	    "IPv4 or IPv6 address of the server (default 127.0.0.1)")(
+	    "port", boost::program_options::value(&port),
+	    "port of the server")(
+	    "connections", boost::program_options::value(&connection_count),
+	    "number of keep-alive connections (default 64)")(
+	    "duration", boost::program_options::value(&duration_seconds),
+	    "seconds to measure for (default 10)")(
+	    "warm-up", boost::program_options::value(&warm_up_seconds),
+	    "seconds of requests that are not measured (default 1)")(
+	    "threads", boost::program_options::value(&thread_count),
+	    "number of threads sending requests (default 1)")(
+	    "accept-encoding", boost::program_options::value(&accept_encoding),
+	    "value of the Accept-Encoding field, empty for none (default gzip)")(
+	    "url", boost::program_options::value(&urls),
+	    "the URLs to request in turn (default: the front page with its "
+	    "stylesheets and script)");
+
+	boost::program_options::positional_options_description positional;
+	positional.add("url", -1);
+	boost::program_options::variables_map vm;
+	try
+	{
+		boost::program_options::store(
+		    boost::program_options::command_line_parser(argc, argv)
+		        .options(desc)
+		        .positional(positional)
+		        .run(),
+		    vm);
+	}
+	catch (boost::program_options::error const &ex)
+	{
+		std::cerr << ex.what() << '\n' << desc << "\n";
+		return 1;
+	}
+
+	boost::program_options::notify(vm);
+
+	if (vm.count("help"))
+	{
+		std::cerr << desc << "\n";
+		return 1;
+	}
+
+	if ((port == 0) || (connection_count < 1) || (thread_count < 1) ||
+	    (duration_seconds < 1))
+	{
+		std::cerr << "A port, at least one connection, one thread and one "
+		             "second are required.\n";
+		std::cerr << desc << "\n";
+		return 1;
+	}
+
+	if (urls.empty())
+	{
+		// what a browser loads for the blog
+		urls = {"/", "/stylesheets.css", "/stylesheets-dark.css",
+		        "/toggleTheme.js"};
+	}
+
+	try
+	{
+		using namespace boost::asio;
+
+		io_service io;
+		load_test test(io);
+		test.server =
+		    ip::tcp::endpoint(ip::address::from_string(host), port);
+		for (std::string const &url : urls)
+		{
+			test.requests.emplace_back(
+			    serialize_request(host, url, accept_encoding));
+		}
+		clock::time_point const start = clock::now();
+		test.measure_from = start + std::chrono::seconds(warm_up_seconds);
+		test.measure_until =
+		    test.measure_from + std::chrono::seconds(duration_seconds);
+
+		test.give_up.expires_at(test.measure_until + std::chrono::seconds(5));
+		test.give_up.async_wait([&io](boost::system::error_code const ec)
+		                        {
+			                        if (!ec)
+			                        {
+				                        std::cerr << "Some responses did not "
+				                                     "arrive in time\n";
+				                        io.stop();
+			                        }
+			                    });
+
+		test.running_connections = connection_count;
+		std::vector<std::unique_ptr<load_connection>> connections;
+		for (std::size_t i = 0; i < connection_count; ++i)
+		{
+			// The connections start at different URLs so that the mix is
+			// the same at every moment.
+			connections.emplace_back(std::make_unique<load_connection>(
+			    io, test, i % test.requests.size()));
+			connect(*connections.back());
+		}
+
+		std::vector<std::thread> threads;
+		for (unsigned i = 1; i < thread_count; ++i)
+		{
+			threads.emplace_back([&io]()
+			                     {
+				                     io.run();
+				                 });
+		}
+		io.run();
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		latency_histogram latencies;
+		std::size_t failed_connections = 0;
+		std::size_t error_responses = 0;
+		std::size_t reconnects = 0;
+		for (std::unique_ptr<load_connection> const &connection : connections)
+		{
+			latencies.add(connection->latencies);
+			failed_connections += connection->failed_connections;
+			error_responses += connection->error_responses;
+			reconnects += connection->reconnects;
+		}
+
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << "requests: " << latencies.count() << " in "
+		          << duration_seconds << " s ("
+		          << (static_cast<double>(latencies.count()) /
+		              duration_seconds)
+		          << " per second)\n";
+		std::cout << "failed connections: " << failed_connections
+		          << ", error responses: " << error_responses
+		          << ", reconnects: " << reconnects << '\n';
+		std::cout << std::setprecision(3);
+		std::cout << "latency in ms: p50 "
+		          << to_milliseconds(latencies.percentile(0.5)) << ", p99 "
+		          << to_milliseconds(latencies.percentile(0.99)) << ", p99.9 "
+		          << to_milliseconds(latencies.percentile(0.999)) << ", max "
+		          << to_milliseconds(latencies.max()) << '\n';
+		return (failed_connections == 0) ? 0 : 1;
+	}
+	catch (boost::system::system_error const &ex)
+	{
+		std::cerr << "boost::system::system_error: " << ex.code() << '\n';
+		return 1;
+	}
+	catch (std::exception const &ex)
+	{
+		std::cerr << "std::exception: " << ex.what() << '\n';
+		return 1;
+	}
+}
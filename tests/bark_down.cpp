@@ -26,4 +26,45 @@ BOOST_AUTO_TEST_CASE(render_inline_code)
 	    "<p>Code: <span "
 	    "class=\"inlineCodeSnippet\"><code><span "
 	    "class=\"keyword\">int</span> i = 0;</code></span></p>");
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(render_table)
+{
+	check_code_rendering(
+	    "Before\n\n| Type | Purpose |\n|---|---|\n| `int` | a & b |\n"
+	    "| x |y|\n\nAfter",
+	    "<p>Before\n</p><table><thead><tr><th>Type</th><th>Purpose</th></tr>"
+	    "</thead><tr><td><span class=\"inlineCodeSnippet\"><code><span "
+	    "class=\"keyword\">int</span></code></span></td><td>a &amp; "
+	    "b</td></tr><tr><td>x</td><td>y</td></tr></table><p>\nAfter</p>");
+}
+
+BOOST_AUTO_TEST_CASE(render_pipes_without_separator_as_text)
+{
+	check_code_rendering("| a |\n| b |", "<p>| a |\n| b |</p>");
+}
+
+BOOST_AUTO_TEST_CASE(render_unterminated_inline_code)
+{
+	check_code_rendering("Code: `int",
+	                     "<p>Code: <span class=\"inlineCodeSnippet\"><code><"
+	                     "span class=\"keyword\">int</span></code></span></p>");
+}
+
+BOOST_AUTO_TEST_CASE(render_paragraphs)
+{
+	check_code_rendering("a\n\nb", "<p>a\n</p><p>\nb</p>");
+}
+
+BOOST_AUTO_TEST_CASE(render_paragraphs_with_crlf)
+{
+	check_code_rendering("line one\r\nline two\r\n\r\nnext",
+	                     "<p>line one\r\nline two\r\n</p><p>\r\nnext</p>");
+}
+
+BOOST_AUTO_TEST_CASE(render_table_with_crlf)
+{
+	check_code_rendering(
+	    "Before\r\n\r\n| a | b |\r\n|---|---|\r\n| c | d |\r\n\r\nAfter",
+	    "<p>Before\r\n</p><table><thead><tr><th>a</th><th>b</th></tr>"
+	    "</thead><tr><td>c</td><td>d</td></tr></table><p>\r\nAfter</p>");
+}
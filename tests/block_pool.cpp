@@ -0,0 +1,56 @@
+#include "html_generator/server/block_pool.hpp"
+#include <boost/test/unit_test.hpp>
+#include <memory>
+
+BOOST_AUTO_TEST_CASE(block_pool_reuses_freed_block)
+{
+	block_pool pool(2);
+	void *const first = pool.allocate(64);
+	pool.deallocate(first, 64);
+	BOOST_CHECK_EQUAL(1u, pool.kept_blocks());
+	BOOST_CHECK_EQUAL(first, pool.allocate(64));
+	BOOST_CHECK_EQUAL(0u, pool.kept_blocks());
+	pool.deallocate(first, 64);
+}
+
+BOOST_AUTO_TEST_CASE(block_pool_keeps_only_one_size)
+{
+	block_pool pool(2);
+	void *const pooled = pool.allocate(64);
+	void *const other = pool.allocate(128);
+	pool.deallocate(other, 128);
+	BOOST_CHECK_EQUAL(0u, pool.kept_blocks());
+	pool.deallocate(pooled, 64);
+	BOOST_CHECK_EQUAL(1u, pool.kept_blocks());
+}
+
+BOOST_AUTO_TEST_CASE(block_pool_keeps_at_most_max_kept)
+{
+	block_pool pool(1);
+	void *const first = pool.allocate(64);
+	void *const second = pool.allocate(64);
+	pool.deallocate(first, 64);
+	pool.deallocate(second, 64);
+	BOOST_CHECK_EQUAL(1u, pool.kept_blocks());
+}
+
+BOOST_AUTO_TEST_CASE(block_pool_allocate_shared)
+{
+	block_pool pool(4);
+	std::weak_ptr<int> observer;
+	int *first_address = nullptr;
+	{
+		auto const first =
+		    std::allocate_shared<int>(pool_allocator<int>(pool), 1);
+		first_address = first.get();
+		observer = first;
+	}
+	// the weak_ptr still needs the reference count
+	BOOST_CHECK_EQUAL(0u, pool.kept_blocks());
+	observer.reset();
+	BOOST_CHECK_EQUAL(1u, pool.kept_blocks());
+	auto const second =
+	    std::allocate_shared<int>(pool_allocator<int>(pool), 2);
+	BOOST_CHECK_EQUAL(first_address, second.get());
+	BOOST_CHECK_EQUAL(2, *second);
+}
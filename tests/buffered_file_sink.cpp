@@ -0,0 +1,71 @@
+#include "html_generator/buffered_file_sink.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ventura/file_operations.hpp>
+
+namespace
+{
+	struct open_temporary_file : temporary_file
+	{
+		Si::error_or<Si::file_handle> const handle =
+		    ventura::overwrite_file(ventura::safe_c_str(ventura::to_os_string(
+		        *ventura::absolute_path::create(path))));
+		Si::native_file_descriptor const descriptor = handle.get().handle;
+	};
+
+	boost::system::error_code append(buffered_file_sink &sink,
+	                                 std::string const &data)
+	{
+		return sink.append(
+		    Si::make_iterator_range(data.data(), data.data() + data.size()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_sink_small_pieces)
+{
+	open_temporary_file const file;
+	buffered_file_sink sink(file.descriptor, 1024);
+	std::string expected;
+	for (int i = 0; i < 1000; ++i)
+	{
+		BOOST_REQUIRE(!append(sink, "<p>"));
+		expected += "<p>";
+	}
+	BOOST_REQUIRE(!sink.flush());
+	BOOST_CHECK_EQUAL(expected, read_file(file.path));
+	// 3000 bytes through a buffer of 1024
+	BOOST_CHECK_EQUAL(3u, sink.write_calls());
+	BOOST_CHECK_EQUAL(expected.size(), sink.written_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_sink_large_piece)
+{
+	open_temporary_file const file;
+	buffered_file_sink sink(file.descriptor, 16);
+	std::string const large(100, 'a');
+	BOOST_REQUIRE(!append(sink, "<p>"));
+	BOOST_REQUIRE(!append(sink, large));
+	BOOST_REQUIRE(!append(sink, "</p>"));
+	BOOST_REQUIRE(!sink.flush());
+	BOOST_CHECK_EQUAL("<p>" + large + "</p>", read_file(file.path));
+	// the buffer and the large piece are written together
+	BOOST_CHECK_EQUAL(2u, sink.write_calls());
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_sink_flush_empty)
+{
+	open_temporary_file const file;
+	buffered_file_sink sink(file.descriptor);
+	BOOST_REQUIRE(!sink.flush());
+	BOOST_CHECK_EQUAL(0u, sink.write_calls());
+	BOOST_CHECK_EQUAL("", read_file(file.path));
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(buffered_file_sink_reports_errors)
+{
+	buffered_file_sink sink(-1);
+	BOOST_REQUIRE(!append(sink, "<p>"));
+	BOOST_CHECK(!!sink.flush());
+}
+#endif
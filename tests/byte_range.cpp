@@ -0,0 +1,69 @@
+#include "html_generator/server/byte_range.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	void check_range(range_kind const expected_kind,
+	                 std::size_t const expected_first,
+	                 std::size_t const expected_length,
+	                 requested_range const &actual)
+	{
+		BOOST_CHECK(expected_kind == actual.kind);
+		BOOST_CHECK_EQUAL(expected_first, actual.first);
+		BOOST_CHECK_EQUAL(expected_length, actual.length);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(parse_range_first_last)
+{
+	check_range(range_kind::partial, 0, 500, parse_range("bytes=0-499", 1000));
+	check_range(range_kind::partial, 500, 500,
+	            parse_range("bytes=500-999", 1000));
+	// the last position is limited to the size
+	check_range(range_kind::partial, 900, 100,
+	            parse_range("bytes=900-2000", 1000));
+}
+
+BOOST_AUTO_TEST_CASE(parse_range_open_ended)
+{
+	check_range(range_kind::partial, 400, 600, parse_range("bytes=400-", 1000));
+}
+
+BOOST_AUTO_TEST_CASE(parse_range_suffix)
+{
+	check_range(range_kind::partial, 900, 100, parse_range("bytes=-100", 1000));
+	check_range(range_kind::partial, 0, 1000, parse_range("bytes=-5000", 1000));
+	check_range(range_kind::unsatisfiable, 0, 0, parse_range("bytes=-0", 1000));
+}
+
+BOOST_AUTO_TEST_CASE(parse_range_unsatisfiable)
+{
+	check_range(range_kind::unsatisfiable, 0, 0,
+	            parse_range("bytes=1000-", 1000));
+	check_range(range_kind::unsatisfiable, 0, 0, parse_range("bytes=0-", 0));
+	check_range(range_kind::unsatisfiable, 0, 0,
+	            parse_range("bytes=99999999999999999999999-", 1000));
+}
+
+BOOST_AUTO_TEST_CASE(parse_range_ignored)
+{
+	check_range(range_kind::whole, 0, 1000, parse_range("", 1000));
+	check_range(range_kind::whole, 0, 1000, parse_range("items=0-1", 1000));
+	check_range(range_kind::whole, 0, 1000, parse_range("bytes=5-1", 1000));
+	check_range(range_kind::whole, 0, 1000, parse_range("bytes=a-1", 1000));
+	check_range(range_kind::whole, 0, 1000, parse_range("bytes=-", 1000));
+	check_range(range_kind::whole, 0, 1000,
+	            parse_range("bytes=0-1,5-6", 1000));
+}
+
+BOOST_AUTO_TEST_CASE(if_range)
+{
+	BOOST_CHECK(if_range_matches("\"abc\"", "\"abc\"", 0));
+	BOOST_CHECK(!if_range_matches("\"abd\"", "\"abc\"", 0));
+	BOOST_CHECK(!if_range_matches("W/\"abc\"", "\"abc\"", 0));
+	BOOST_CHECK(
+	    if_range_matches("Sun, 06 Nov 1994 08:49:37 GMT", "\"a\"", 784111777));
+	BOOST_CHECK(
+	    !if_range_matches("Sun, 06 Nov 1994 08:49:38 GMT", "\"a\"", 784111777));
+	BOOST_CHECK(!if_range_matches("garbage", "\"a\"", 784111777));
+}
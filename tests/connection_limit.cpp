@@ -0,0 +1,31 @@
+#include "html_generator/server/connection_limit.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(connection_limit_below_limit)
+{
+	connection_limit limit(2);
+	BOOST_CHECK(limit.try_acquire(nullptr));
+	BOOST_CHECK(limit.try_acquire(nullptr));
+	BOOST_CHECK_EQUAL(2u, limit.open_connections());
+	limit.release();
+	BOOST_CHECK_EQUAL(1u, limit.open_connections());
+}
+
+BOOST_AUTO_TEST_CASE(connection_limit_resumes_after_release)
+{
+	connection_limit limit(1);
+	BOOST_REQUIRE(limit.try_acquire(nullptr));
+	int resumed = 0;
+	BOOST_CHECK(!limit.try_acquire([&resumed]()
+	                               {
+		                               ++resumed;
+		                           }));
+	BOOST_CHECK_EQUAL(0, resumed);
+	limit.release();
+	BOOST_CHECK_EQUAL(1, resumed);
+	BOOST_CHECK_EQUAL(0u, limit.open_connections());
+	// resume is only called once
+	BOOST_REQUIRE(limit.try_acquire(nullptr));
+	limit.release();
+	BOOST_CHECK_EQUAL(1, resumed);
+}
@@ -0,0 +1,63 @@
+#include "html_generator/server/content_encoding.hpp"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace
+{
+	void check_negotiation(boost::string_ref const accept_encoding,
+	                       std::vector<content_encoding> const &expected)
+	{
+		acceptable_encodings const negotiated =
+		    negotiate_encodings(accept_encoding);
+		std::vector<content_encoding> const got(negotiated.begin(),
+		                                        negotiated.end());
+		BOOST_CHECK(expected == got);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(accept_encoding_quality_default)
+{
+	BOOST_CHECK_EQUAL(1000u, accepted_encoding_quality("gzip", "gzip"));
+	BOOST_CHECK_EQUAL(0u, accepted_encoding_quality("gzip", "br"));
+	BOOST_CHECK_EQUAL(0u, accepted_encoding_quality("", "gzip"));
+}
+
+BOOST_AUTO_TEST_CASE(accept_encoding_quality_values)
+{
+	BOOST_CHECK_EQUAL(
+	    500u, accepted_encoding_quality("deflate, gzip;q=0.5", "gzip"));
+	BOOST_CHECK_EQUAL(0u, accepted_encoding_quality("gzip ; q=0", "gzip"));
+	BOOST_CHECK_EQUAL(1000u, accepted_encoding_quality("gzip;Q=1.0", "gzip"));
+	BOOST_CHECK_EQUAL(125u, accepted_encoding_quality("GZIP;q=0.125", "gzip"));
+}
+
+BOOST_AUTO_TEST_CASE(accept_encoding_quality_wildcard)
+{
+	BOOST_CHECK_EQUAL(300u, accepted_encoding_quality("*;q=0.3", "br"));
+	BOOST_CHECK_EQUAL(0u, accepted_encoding_quality("*, br;q=0", "br"));
+}
+
+BOOST_AUTO_TEST_CASE(negotiate_encodings_without_header)
+{
+	check_negotiation("", {content_encoding::identity});
+}
+
+BOOST_AUTO_TEST_CASE(negotiate_encodings_typical_browser)
+{
+	check_negotiation("gzip, deflate, br",
+	                  {content_encoding::brotli, content_encoding::gzip,
+	                   content_encoding::identity});
+}
+
+BOOST_AUTO_TEST_CASE(negotiate_encodings_gzip_preferred)
+{
+	check_negotiation("br;q=0.5, gzip",
+	                  {content_encoding::gzip, content_encoding::brotli,
+	                   content_encoding::identity});
+}
+
+BOOST_AUTO_TEST_CASE(negotiate_encodings_gzip_only)
+{
+	check_negotiation("gzip",
+	                  {content_encoding::gzip, content_encoding::identity});
+}
@@ -168,3 +168,24 @@ BOOST_AUTO_TEST_CASE(render_a_doc_comment)
 	                     "<span class=\"comment\">/**Special documentation "
 	                     "comment incoming*/</span>\n");
 }
+
+BOOST_AUTO_TEST_CASE(is_keyword_all_lengths)
+{
+	for (boost::string_ref const keyword :
+	     {"do", "xor", "auto", "while", "xor_eq", "wchar_t", "volatile",
+	      "protected", "const_cast", "static_cast", "thread_local",
+	      "static_assert", "reinterpret_cast", "and", "alignas", "bitand"})
+	{
+		BOOST_CHECK_MESSAGE(is_keyword(keyword), keyword);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(is_keyword_not_a_keyword)
+{
+	for (boost::string_ref const identifier :
+	     {"", "i", "doo", "Int", "int_", "whilst", "a_cast", "size_t",
+	      "reinterpret_casts", "zzzzzzzz", "aaaa"})
+	{
+		BOOST_CHECK_MESSAGE(!is_keyword(identifier), identifier);
+	}
+}
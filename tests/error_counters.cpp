@@ -0,0 +1,32 @@
+#include "html_generator/server/error_counters.hpp"
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+BOOST_AUTO_TEST_CASE(error_counters_disconnect)
+{
+	BOOST_CHECK(is_disconnect(boost::asio::error::eof));
+	BOOST_CHECK(is_disconnect(boost::asio::error::connection_reset));
+	BOOST_CHECK(is_disconnect(boost::asio::error::broken_pipe));
+	BOOST_CHECK(!is_disconnect(boost::asio::error::no_memory));
+	BOOST_CHECK(!is_disconnect(boost::asio::error::operation_aborted));
+}
+
+BOOST_AUTO_TEST_CASE(error_counters_count)
+{
+	error_counters counters;
+	counters.count(io_direction::read, boost::asio::error::eof);
+	counters.count(io_direction::write, boost::asio::error::broken_pipe);
+	counters.count(io_direction::read, boost::asio::error::no_memory);
+	counters.count(io_direction::write, boost::asio::error::no_buffer_space);
+	counters.count(io_direction::write, boost::asio::error::no_buffer_space);
+	BOOST_CHECK_EQUAL(2u, counters.disconnects);
+	BOOST_CHECK_EQUAL(1u, counters.read_errors);
+	BOOST_CHECK_EQUAL(2u, counters.write_errors);
+	BOOST_CHECK_EQUAL(0u, counters.accept_errors);
+	BOOST_CHECK_EQUAL(0u, counters.timeouts);
+	std::ostringstream formatted;
+	formatted << counters;
+	BOOST_CHECK_EQUAL("accept errors: 0, read errors: 1, write errors: 2, "
+	                  "disconnects: 2, timeouts: 0",
+	                  formatted.str());
+}
@@ -0,0 +1,62 @@
+#include "html_generator/error_latching_sink.hpp"
+#include <boost/test/unit_test.hpp>
+#include <silicium/html/tree.hpp>
+
+namespace
+{
+	// fails after accepting limit bytes
+	struct limited_sink
+	{
+		typedef char element_type;
+		typedef boost::system::error_code error_type;
+
+		std::string written;
+		std::size_t limit;
+		std::size_t append_calls = 0;
+
+		error_type append(Si::iterator_range<char const *> const data)
+		{
+			++append_calls;
+			std::size_t const size = static_cast<std::size_t>(data.size());
+			if ((written.size() + size) > limit)
+			{
+				return boost::system::errc::make_error_code(
+				    boost::system::errc::no_space_on_device);
+			}
+			written.append(data.begin(), data.end());
+			return {};
+		}
+	};
+}
+
+BOOST_AUTO_TEST_CASE(error_latching_sink_success)
+{
+	limited_sink next;
+	next.limit = 100;
+	boost::system::error_code first_error;
+	auto erased = Si::Sink<char, Si::success>::erase(
+	    make_error_latching_sink(next, first_error));
+	Si::html::tag("p", Si::html::text("a < b")).generate(erased);
+	BOOST_CHECK(!first_error);
+	BOOST_CHECK_EQUAL("<p>a &lt; b</p>", next.written);
+}
+
+BOOST_AUTO_TEST_CASE(error_latching_sink_keeps_first_error)
+{
+	limited_sink next;
+	next.limit = 3;
+	boost::system::error_code first_error;
+	auto sink = make_error_latching_sink(next, first_error);
+	std::string const pieces[] = {"<p>", "text", "</p>"};
+	for (std::string const &piece : pieces)
+	{
+		sink.append(Si::make_iterator_range(piece.data(),
+		                                    piece.data() + piece.size()));
+	}
+	BOOST_CHECK_EQUAL(boost::system::errc::make_error_code(
+	                      boost::system::errc::no_space_on_device),
+	                  first_error);
+	BOOST_CHECK_EQUAL("<p>", next.written);
+	// nothing is passed on after the error
+	BOOST_CHECK_EQUAL(2u, next.append_calls);
+}
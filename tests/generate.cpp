@@ -0,0 +1,26 @@
+#include "html_generator/generate.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(generate_all_html_removes_temporary_after_exception)
+{
+	temporary_directory const directory;
+	boost::filesystem::create_directories(directory.path / "snippets");
+	boost::filesystem::create_directories(directory.path / "posts");
+	boost::filesystem::create_directories(directory.path / "output");
+	directory.write("snippets/unbalanced.cpp", "char const *a = \"a;\n");
+	directory.write("posts/post.md",
+	                "---\ntitle: A\n---\nText\n@snippet unbalanced.cpp\n");
+	ventura::absolute_path const output =
+	    *ventura::absolute_path::create(directory.path / "output");
+	BOOST_CHECK_THROW(
+	    generate_all_html(
+	        *ventura::absolute_path::create(directory.path / "snippets"),
+	        *ventura::absolute_path::create(directory.path / "posts"), output,
+	        "index.html"),
+	    std::invalid_argument);
+	BOOST_CHECK(!boost::filesystem::exists(directory.path / "output" /
+	                                       "index.html.tmp"));
+	BOOST_CHECK(
+	    !boost::filesystem::exists(directory.path / "output" / "index.html"));
+}
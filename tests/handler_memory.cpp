@@ -0,0 +1,39 @@
+#include "html_generator/server/handler_memory.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(handler_memory_slots)
+{
+	handler_memory memory;
+	void *slots[handler_memory::slot_count];
+	for (void *&slot : slots)
+	{
+		slot = memory.allocate(100);
+	}
+	// all slots are used, so this comes from the heap
+	void *const overflow = memory.allocate(100);
+	void *const too_large = memory.allocate(handler_memory::slot_size + 1);
+	memory.deallocate(overflow);
+	memory.deallocate(too_large);
+	memory.deallocate(slots[1]);
+	BOOST_CHECK_EQUAL(slots[1], memory.allocate(100));
+	for (void *const slot : slots)
+	{
+		memory.deallocate(slot);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(handler_memory_pooled_handler)
+{
+	handler_memory memory;
+	int called = 0;
+	auto handler = make_pooled_handler(memory, [&called](int const value)
+	                                   {
+		                                   called = value;
+		                               });
+	void *const allocated = asio_handler_allocate(16, &handler);
+	memory.deallocate(allocated);
+	BOOST_CHECK_EQUAL(allocated, memory.allocate(16));
+	memory.deallocate(allocated);
+	handler(3);
+	BOOST_CHECK_EQUAL(3, called);
+}
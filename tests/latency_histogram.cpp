@@ -0,0 +1,52 @@
+#include "loadgen/latency_histogram.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(latency_histogram_empty)
+{
+	latency_histogram histogram;
+	BOOST_CHECK_EQUAL(0u, histogram.count());
+	BOOST_CHECK(latency_histogram::duration(0) == histogram.percentile(0.5));
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_small_values_are_exact)
+{
+	latency_histogram histogram;
+	for (int i = 1; i <= 10; ++i)
+	{
+		histogram.record(latency_histogram::duration(i));
+	}
+	BOOST_CHECK_EQUAL(10u, histogram.count());
+	BOOST_CHECK_EQUAL(5, histogram.percentile(0.5).count());
+	BOOST_CHECK_EQUAL(10, histogram.percentile(0.99).count());
+	BOOST_CHECK_EQUAL(10, histogram.max().count());
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_relative_error)
+{
+	latency_histogram histogram;
+	for (int i = 0; i < 999; ++i)
+	{
+		histogram.record(std::chrono::microseconds(100));
+	}
+	histogram.record(std::chrono::milliseconds(20));
+	auto const p50 = histogram.percentile(0.5).count();
+	BOOST_CHECK_GE(p50, 100000);
+	BOOST_CHECK_LE(p50, 100000 + 100000 / 16);
+	BOOST_CHECK_EQUAL(p50, histogram.percentile(0.999).count());
+	// the slowest request is reported as it was measured
+	BOOST_CHECK_EQUAL(20000000, histogram.percentile(1.0).count());
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_add)
+{
+	latency_histogram first;
+	latency_histogram second;
+	first.record(latency_histogram::duration(3));
+	second.record(latency_histogram::duration(7));
+	second.record(latency_histogram::duration(7));
+	first.add(second);
+	BOOST_CHECK_EQUAL(3u, first.count());
+	BOOST_CHECK_EQUAL(3, first.percentile(0.3).count());
+	BOOST_CHECK_EQUAL(7, first.percentile(0.5).count());
+	BOOST_CHECK_EQUAL(7, first.max().count());
+}
@@ -0,0 +1,73 @@
+#include "html_generator/manifest.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	std::string hash_of(boost::filesystem::path const &directory)
+	{
+		content_hash hash;
+		BOOST_REQUIRE(!hash_directory(hash, directory));
+		return hash.to_hex();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(content_hash_is_delimited)
+{
+	content_hash first;
+	first.add_delimited("ab");
+	first.add_delimited("c");
+	content_hash second;
+	second.add_delimited("a");
+	second.add_delimited("bc");
+	BOOST_CHECK_NE(first.to_hex(), second.to_hex());
+	BOOST_CHECK_EQUAL("cbf29ce484222325", content_hash().to_hex());
+}
+
+BOOST_AUTO_TEST_CASE(hash_directory_notices_changes)
+{
+	temporary_directory const directory;
+	directory.write("a.cpp", "int a;");
+	directory.write("b.cpp", "int b;");
+	std::string const original = hash_of(directory.path);
+	BOOST_CHECK_EQUAL(original, hash_of(directory.path));
+
+	directory.write("b.cpp", "int c;");
+	std::string const changed = hash_of(directory.path);
+	BOOST_CHECK_NE(original, changed);
+
+	boost::filesystem::rename(directory.path / "b.cpp",
+	                          directory.path / "c.cpp");
+	BOOST_CHECK_NE(changed, hash_of(directory.path));
+}
+
+BOOST_AUTO_TEST_CASE(hash_directory_missing)
+{
+	content_hash hash;
+	boost::filesystem::path const missing =
+	    boost::filesystem::temp_directory_path() /
+	    boost::filesystem::unique_path();
+	BOOST_CHECK(!!hash_directory(hash, missing));
+}
+
+BOOST_AUTO_TEST_CASE(build_manifest_round_trip)
+{
+	temporary_directory const directory;
+	boost::filesystem::path const file = directory.path / "cache/manifest.txt";
+	{
+		build_manifest manifest(file);
+		manifest.load();
+		BOOST_CHECK(!manifest.is_up_to_date("index.html", "0123456789abcdef"));
+		manifest.record("index.html", "0123456789abcdef");
+		manifest.record("name with spaces.css", "fedcba9876543210");
+		BOOST_REQUIRE(!manifest.save());
+	}
+	build_manifest manifest(file);
+	manifest.load();
+	BOOST_CHECK(manifest.is_up_to_date("index.html", "0123456789abcdef"));
+	BOOST_CHECK(!manifest.is_up_to_date("index.html", "0123456789abcdee"));
+	BOOST_CHECK(
+	    manifest.is_up_to_date("name with spaces.css", "fedcba9876543210"));
+	manifest.forget("index.html");
+	BOOST_CHECK(!manifest.is_up_to_date("index.html", "0123456789abcdef"));
+}
@@ -0,0 +1,65 @@
+#include "html_generator/parallel.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+	std::vector<std::function<int()>> make_tasks(int const count)
+	{
+		std::vector<std::function<int()>> tasks;
+		for (int i = 0; i < count; ++i)
+		{
+			tasks.emplace_back([i]()
+			                   {
+				                   // uneven durations mix up the scheduling
+				                   std::chrono::microseconds const duration(
+				                       (i % 3) * 100);
+				                   std::this_thread::sleep_for(duration);
+				                   return i * i;
+				               });
+		}
+		return tasks;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(run_in_parallel_keeps_order)
+{
+	for (unsigned jobs : {0u, 1u, 2u, 8u, 100u})
+	{
+		std::vector<int> const results = run_in_parallel(make_tasks(20), jobs);
+		BOOST_REQUIRE_EQUAL(20u, results.size());
+		for (int i = 0; i < 20; ++i)
+		{
+			BOOST_CHECK_EQUAL(i * i, results[static_cast<std::size_t>(i)]);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(run_in_parallel_nothing)
+{
+	BOOST_CHECK(run_in_parallel(make_tasks(0), 4).empty());
+}
+
+BOOST_AUTO_TEST_CASE(run_in_parallel_rethrows_first_exception)
+{
+	std::vector<std::function<int()>> tasks = make_tasks(10);
+	tasks[7] = []() -> int
+	{
+		throw std::runtime_error("7");
+	};
+	tasks[3] = []() -> int
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		throw std::runtime_error("3");
+	};
+	try
+	{
+		run_in_parallel(tasks, 4);
+		BOOST_FAIL("an exception was expected");
+	}
+	catch (std::runtime_error const &ex)
+	{
+		BOOST_CHECK_EQUAL("3", std::string(ex.what()));
+	}
+}
@@ -0,0 +1,42 @@
+#include "html_generator/posts.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(parse_post_with_title)
+{
+	post const parsed =
+	    parse_post("---\ntitle:  Integer types \n---\nText\n\nMore", "test");
+	BOOST_CHECK_EQUAL("Integer types", parsed.title);
+	BOOST_CHECK_EQUAL("Text\n\nMore", parsed.content());
+}
+
+BOOST_AUTO_TEST_CASE(parse_post_ignores_other_keys)
+{
+	post const parsed = parse_post(
+	    "---\r\ndate: 2017-04-05\r\ntitle: A\r\n---\r\nText", "test");
+	BOOST_CHECK_EQUAL("A", parsed.title);
+	BOOST_CHECK_EQUAL("Text", parsed.content());
+}
+
+BOOST_AUTO_TEST_CASE(parse_post_without_front_matter)
+{
+	BOOST_CHECK_THROW(parse_post("title: A\n---\nText", "test"),
+	                  std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(parse_post_without_title)
+{
+	BOOST_CHECK_THROW(parse_post("---\ndate: 2017-04-05\n---\nText", "test"),
+	                  std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(parse_post_with_unterminated_front_matter)
+{
+	BOOST_CHECK_THROW(parse_post("---\ntitle: A\nText", "test"),
+	                  std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(parse_post_with_malformed_front_matter)
+{
+	BOOST_CHECK_THROW(parse_post("---\ntitle A\n---\nText", "test"),
+	                  std::runtime_error);
+}
@@ -0,0 +1,35 @@
+#include "html_generator/replace_file.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(replace_with_temporary_replaces_the_file)
+{
+	temporary_directory const directory;
+	boost::filesystem::path const file = directory.path / "index.html";
+	write_file(file, "old");
+	write_file(temporary_path_for(file), "new");
+	BOOST_REQUIRE(!replace_with_temporary(file));
+	BOOST_CHECK_EQUAL("new", read_file(file));
+	BOOST_CHECK(!boost::filesystem::exists(temporary_path_for(file)));
+}
+
+BOOST_AUTO_TEST_CASE(replace_with_temporary_without_temporary)
+{
+	temporary_directory const directory;
+	boost::filesystem::path const file = directory.path / "index.html";
+	write_file(file, "old");
+	BOOST_CHECK(!!replace_with_temporary(file));
+	BOOST_CHECK_EQUAL("old", read_file(file));
+}
+
+BOOST_AUTO_TEST_CASE(copy_file_atomically_overwrites)
+{
+	temporary_directory const directory;
+	boost::filesystem::path const source = directory.path / "a.css";
+	boost::filesystem::path const destination = directory.path / "b.css";
+	write_file(source, "new");
+	write_file(destination, "old");
+	BOOST_REQUIRE(!copy_file_atomically(source, destination));
+	BOOST_CHECK_EQUAL("new", read_file(destination));
+	BOOST_CHECK(!boost::filesystem::exists(temporary_path_for(destination)));
+}
@@ -0,0 +1,109 @@
+#include "html_generator/server/response_cache.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	std::shared_ptr<cached_response const>
+	make_response(boost::filesystem::path const &source,
+	              std::string body)
+	{
+		auto response = std::make_shared<cached_response>();
+		response->source = source;
+		response->version = *get_file_version(source);
+		response->copied_body = std::move(body);
+		return response;
+	}
+
+	std::chrono::seconds const revalidation_interval(1);
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_miss)
+{
+	response_cache cache(1000, revalidation_interval);
+	BOOST_CHECK(!cache.find("/", response_cache::clock::now()));
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_hit)
+{
+	temporary_file const file("content");
+	response_cache cache(1000, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	auto const response = make_response(file.path, "response");
+	BOOST_REQUIRE(cache.insert("/", response, now));
+	BOOST_CHECK_EQUAL(response, cache.find("/", now));
+	BOOST_CHECK_EQUAL(9u, cache.used_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_clear)
+{
+	temporary_file const file("content");
+	response_cache cache(1000, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	BOOST_REQUIRE(cache.insert("/", make_response(file.path, "response"), now));
+	cache.clear();
+	BOOST_CHECK(!cache.find("/", now));
+	BOOST_CHECK_EQUAL(0u, cache.used_bytes());
+	BOOST_CHECK_EQUAL(0u, cache.entry_count());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_too_large)
+{
+	temporary_file const file("content");
+	response_cache cache(80, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	BOOST_CHECK(
+	    !cache.insert("/", make_response(file.path, "0123456789"), now));
+	BOOST_CHECK(!cache.find("/", now));
+	BOOST_CHECK_EQUAL(0u, cache.used_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_evicts_least_recently_used)
+{
+	temporary_file const file("content");
+	response_cache cache(160, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	BOOST_REQUIRE(cache.insert("/a", make_response(file.path, "a"), now));
+	BOOST_REQUIRE(cache.insert("/b", make_response(file.path, "b"), now));
+	BOOST_REQUIRE(cache.find("/a", now));
+	// fill the cache so that exactly one of the small entries has to go
+	for (int i = 0; i < 7; ++i)
+	{
+		BOOST_REQUIRE(cache.insert(
+		    "/" + boost::lexical_cast<std::string>(i),
+		    make_response(file.path, std::string(18, 'x')), now));
+	}
+	BOOST_REQUIRE(cache.insert(
+	    "/7", make_response(file.path, std::string(15, 'x')), now));
+	BOOST_CHECK(cache.find("/a", now));
+	BOOST_CHECK(!cache.find("/b", now));
+	BOOST_CHECK_EQUAL(160u, cache.used_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_invalidated_by_file_change)
+{
+	temporary_file file("content");
+	response_cache cache(1000, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	BOOST_REQUIRE(
+	    cache.insert("/", make_response(file.path, "response"), now));
+	write_file(file.path, "changed content");
+	// the file is not looked at again within the revalidation interval
+	BOOST_CHECK(cache.find("/", now));
+	BOOST_CHECK(!cache.find("/", now + revalidation_interval));
+	BOOST_CHECK_EQUAL(0u, cache.used_bytes());
+}
+
+BOOST_AUTO_TEST_CASE(response_cache_missing_until_file_appears)
+{
+	temporary_directory const directory;
+	auto missing = std::make_shared<cached_response>();
+	missing->source = directory.path / "index.html.br";
+	missing->missing = true;
+	response_cache cache(1000, revalidation_interval);
+	auto const now = response_cache::clock::now();
+	BOOST_REQUIRE(cache.insert("/ br", missing, now));
+	BOOST_CHECK(cache.find("/ br", now + revalidation_interval));
+	directory.write("index.html.br", "compressed");
+	BOOST_CHECK(!cache.find("/ br", now + 2 * revalidation_interval));
+}
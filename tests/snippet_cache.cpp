@@ -0,0 +1,37 @@
+#include "html_generator/snippet_cache.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(snippet_cache_renders_like_snippet_from_file)
+{
+	temporary_directory const directory;
+	snippet_cache const cache(directory.path, "1");
+	std::string const html = cache.get("int a;\n");
+	BOOST_CHECK_EQUAL(render_snippet_html("int a;\n"), html);
+	BOOST_CHECK_EQUAL(1u, directory.files().size());
+}
+
+BOOST_AUTO_TEST_CASE(snippet_cache_reads_stored_html)
+{
+	temporary_directory const directory;
+	snippet_cache const cache(directory.path, "1");
+	cache.get("int a;\n");
+	std::vector<boost::filesystem::path> const files = directory.files();
+	BOOST_REQUIRE_EQUAL(1u, files.size());
+	{
+		boost::filesystem::ofstream entry(files[0], std::ios::binary);
+		entry << "cached";
+	}
+	BOOST_CHECK_EQUAL("cached", cache.get("int a;\n"));
+}
+
+BOOST_AUTO_TEST_CASE(snippet_cache_key_includes_version)
+{
+	temporary_directory const directory;
+	snippet_cache const old_cache(directory.path, "1");
+	snippet_cache const new_cache(directory.path, "2");
+	old_cache.get("int a;\n");
+	new_cache.get("int a;\n");
+	old_cache.get("int b;\n");
+	BOOST_CHECK_EQUAL(3u, directory.files().size());
+}
@@ -0,0 +1,36 @@
+#include "html_generator/tools/bark_down.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(make_line_numbers_counts_from_one)
+{
+	BOOST_CHECK_EQUAL("", make_line_numbers(0));
+	BOOST_CHECK_EQUAL("1\n", make_line_numbers(1));
+	std::string const numbers = make_line_numbers(100);
+	BOOST_CHECK_EQUAL("1\n2\n", numbers.substr(0, 4));
+	BOOST_CHECK_EQUAL("99\n100\n", numbers.substr(numbers.size() - 7));
+}
+
+BOOST_AUTO_TEST_CASE(clean_snippet_source_without_special_characters)
+{
+	boost::string_ref const source = "int a;\nint b;\n";
+	clean_snippet const clean = clean_snippet_source(source);
+	// nothing is copied
+	BOOST_CHECK(!clean.cleaned_code);
+	BOOST_CHECK_EQUAL(source.data(), clean.code(source).data());
+	BOOST_CHECK_EQUAL(3u, clean.lines);
+}
+
+BOOST_AUTO_TEST_CASE(clean_snippet_source_expands_tabs)
+{
+	boost::string_ref const source = "{\r\n\treturn 0;\r\n}\r\n";
+	clean_snippet const clean = clean_snippet_source(source);
+	BOOST_CHECK_EQUAL("{\n    return 0;\n}\n", clean.code(source));
+	BOOST_CHECK_EQUAL(4u, clean.lines);
+}
+
+BOOST_AUTO_TEST_CASE(clean_snippet_source_empty)
+{
+	clean_snippet const clean = clean_snippet_source("");
+	BOOST_CHECK_EQUAL("", clean.code(""));
+	BOOST_CHECK_EQUAL(1u, clean.lines);
+}
@@ -0,0 +1,126 @@
+#include "html_generator/server/static_files.hpp"
+#include "temporary_directory.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	bool has_encoding(static_file_lookup const &found,
+	                  boost::string_ref const encoding)
+	{
+		BOOST_REQUIRE(found.response);
+		return found.response->representation_fields.find(
+		           "Content-Encoding: " + encoding.to_string() + "\r\n") !=
+		       std::string::npos;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(static_files_best_encoding_after_cached_worse_one)
+{
+	temporary_directory const directory;
+	directory.write("index.html", "<p>");
+	directory.write("index.html.gz", "gzip");
+	directory.write("index.html.br", "brotli");
+	static_files files(*ventura::absolute_path::create(directory.path),
+	                   1024 * 1024);
+	std::string key;
+	static_file_lookup const gzip =
+	    files.find("/", negotiate_encodings("gzip"), key);
+	BOOST_CHECK_EQUAL(200, gzip.status);
+	BOOST_CHECK(has_encoding(gzip, "gzip"));
+	static_file_lookup const brotli =
+	    files.find("/", negotiate_encodings("br, gzip"), key);
+	BOOST_CHECK_EQUAL(200, brotli.status);
+	BOOST_CHECK(has_encoding(brotli, "br"));
+	BOOST_CHECK_EQUAL("brotli", brotli.body());
+}
+
+BOOST_AUTO_TEST_CASE(static_files_falls_back_to_existing_encoding)
+{
+	temporary_directory const directory;
+	directory.write("index.html", "<p>");
+	directory.write("index.html.gz", "gzip");
+	static_files files(*ventura::absolute_path::create(directory.path),
+	                   1024 * 1024);
+	std::string key;
+	for (int i = 0; i < 2; ++i)
+	{
+		// the second time the missing .br is known from the cache
+		static_file_lookup const found =
+		    files.find("/", negotiate_encodings("br, gzip"), key);
+		BOOST_CHECK_EQUAL(200, found.status);
+		BOOST_CHECK(has_encoding(found, "gzip"));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(static_files_errors)
+{
+	temporary_directory const directory;
+	static_files files(*ventura::absolute_path::create(directory.path),
+	                   1024 * 1024);
+	std::string key;
+	acceptable_encodings const identity = negotiate_encodings("");
+	BOOST_CHECK_EQUAL(404, files.find("/missing.html", identity, key).status);
+	BOOST_CHECK_EQUAL(400, files.find("index.html", identity, key).status);
+	BOOST_CHECK_EQUAL(400, files.find("", identity, key).status);
+}
+
+BOOST_AUTO_TEST_CASE(static_files_rejects_traversal)
+{
+	temporary_directory const directory;
+	directory.write("secret.txt", "secret");
+	boost::filesystem::create_directories(directory.path / "public");
+	directory.write("public/index.html", "<p>");
+	static_files files(
+	    *ventura::absolute_path::create(directory.path / "public"),
+	    1024 * 1024);
+	std::string key;
+	acceptable_encodings const identity = negotiate_encodings("");
+	BOOST_CHECK_EQUAL(200, files.find("/index.html", identity, key).status);
+	for (char const *const url :
+	     {"/../secret.txt", "/./index.html", "/a/../index.html",
+	      "//index.html", "/..", "/index.html/", "/..\\secret.txt"})
+	{
+		BOOST_CHECK_EQUAL(400, files.find(url, identity, key).status);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(static_files_maps_large_file_for_one_response)
+{
+	temporary_directory const directory;
+	directory.write("large.html", std::string(1000, 'a'));
+	// files larger than an eighth of the cache are not copied
+	static_files files(*ventura::absolute_path::create(directory.path), 800);
+	std::string key;
+	static_file_lookup const found =
+	    files.find("/large.html", negotiate_encodings(""), key);
+	BOOST_REQUIRE_EQUAL(200, found.status);
+	BOOST_CHECK(!found.response->body_copied);
+	BOOST_CHECK_EQUAL(1000u, found.mapped_body.size());
+	BOOST_CHECK_EQUAL(std::string(1000, 'a'), found.body());
+}
+
+BOOST_AUTO_TEST_CASE(static_files_hashes_uncached_body_once)
+{
+	temporary_directory const directory;
+	directory.write("large.html", "first");
+	boost::filesystem::path const file = directory.path / "large.html";
+	std::time_t const written = boost::filesystem::last_write_time(file);
+	// without a response cache no body is copied
+	static_files files(*ventura::absolute_path::create(directory.path), 0);
+	std::string key;
+	acceptable_encodings const identity = negotiate_encodings("");
+	static_file_lookup const first = files.find("/large.html", identity, key);
+	BOOST_REQUIRE_EQUAL(200, first.status);
+	BOOST_CHECK_EQUAL("first", first.body());
+
+	// A change that keeps the size and the modification time makes the
+	// ETag of the new body differ from the one of the cached metadata.
+	directory.write("large.html", "other");
+	boost::filesystem::last_write_time(file, written);
+	static_file_lookup const second =
+	    files.find("/large.html", identity, key);
+	BOOST_REQUIRE_EQUAL(200, second.status);
+	BOOST_CHECK_EQUAL("other", second.body());
+	BOOST_CHECK_EQUAL(first.response, second.response);
+	BOOST_CHECK_EQUAL(make_strong_etag("first"), second.response->etag);
+}
@@ -123,4 +123,58 @@ BOOST_AUTO_TEST_CASE(ul)
 	tags::ul(tags::li(Si::html::text("Test heading")))
 	    .generate(erased_html_sink);
 	BOOST_CHECK_EQUAL("<ul><li>Test heading</li></ul>", html_generated);
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(tags_prerendered)
+{
+	int make_calls = 0;
+	auto const make = [&make_calls]()
+	{
+		++make_calls;
+		return tags::p(tags::cl("x"), Si::html::text("a < b"));
+	};
+	for (int i = 0; i < 2; ++i)
+	{
+		std::string html_generated;
+		auto erased_html_sink = Si::Sink<char, Si::success>::erase(
+		    Si::make_container_sink(html_generated));
+		tags::prerendered<struct prerendered_test_tag>(make).generate(
+		    erased_html_sink);
+		BOOST_CHECK_EQUAL("<p class=\"x\">a &lt; b</p>", html_generated);
+	}
+	BOOST_CHECK_EQUAL(1, make_calls);
+}
+
+namespace
+{
+	auto make_first()
+	{
+		return Si::html::text("first");
+	}
+
+	auto make_second()
+	{
+		return Si::html::text("second");
+	}
+
+	struct first_tag;
+	struct second_tag;
+
+	template <class Tag, class MakeElement>
+	std::string render_prerendered(MakeElement const &make)
+	{
+		std::string html_generated;
+		auto erased_html_sink = Si::Sink<char, Si::success>::erase(
+		    Si::make_container_sink(html_generated));
+		tags::prerendered<Tag>(make).generate(erased_html_sink);
+		return html_generated;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(tags_prerendered_same_function_type)
+{
+	// both are passed as a pointer of the same type
+	BOOST_CHECK_EQUAL("first", render_prerendered<first_tag>(&make_first));
+	BOOST_CHECK_EQUAL("second", render_prerendered<second_tag>(&make_second));
+	BOOST_CHECK_EQUAL("first", render_prerendered<first_tag>(&make_first));
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <string>
+#include <vector>
+
+// Fixtures for tests that work with files. They get a unique name in the
+// temporary directory of the system and remove what they created when the
+// test ends.
+
+inline void write_file(boost::filesystem::path const &file,
+                       std::string const &content)
+{
+	boost::filesystem::ofstream out(file, std::ios::binary);
+	out << content;
+}
+
+inline std::string read_file(boost::filesystem::path const &file)
+{
+	boost::filesystem::ifstream in(file, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in),
+	                   std::istreambuf_iterator<char>());
+}
+
+struct temporary_file
+{
+	boost::filesystem::path const path =
+	    boost::filesystem::temp_directory_path() /
+	    boost::filesystem::unique_path();
+
+	temporary_file()
+	{
+	}
+
+	explicit temporary_file(std::string const &content)
+	{
+		write_file(path, content);
+	}
+
+	temporary_file(temporary_file const &) = delete;
+	temporary_file &operator=(temporary_file const &) = delete;
+
+	~temporary_file()
+	{
+		boost::system::error_code ignored;
+		boost::filesystem::remove(path, ignored);
+	}
+};
+
+struct temporary_directory
+{
+	boost::filesystem::path const path =
+	    boost::filesystem::temp_directory_path() /
+	    boost::filesystem::unique_path();
+
+	temporary_directory()
+	{
+		boost::filesystem::create_directories(path);
+	}
+
+	temporary_directory(temporary_directory const &) = delete;
+	temporary_directory &operator=(temporary_directory const &) = delete;
+
+	~temporary_directory()
+	{
+		boost::system::error_code ignored;
+		boost::filesystem::remove_all(path, ignored);
+	}
+
+	void write(boost::filesystem::path const &name,
+	           std::string const &content) const
+	{
+		write_file(path / name, content);
+	}
+
+	// the entries of the directory in a stable order
+	std::vector<boost::filesystem::path> files() const
+	{
+		std::vector<boost::filesystem::path> result(
+		    boost::filesystem::directory_iterator(path),
+		    boost::filesystem::directory_iterator{});
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+};
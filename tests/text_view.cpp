@@ -0,0 +1,80 @@
+#include "html_generator/text_view.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	std::string escape(boost::string_ref const content)
+	{
+		std::string html_generated;
+		auto erased_html_sink = Si::Sink<char, Si::success>::erase(
+		    Si::make_container_sink(html_generated));
+		write_escaped_text(erased_html_sink, content);
+		return html_generated;
+	}
+
+	std::string escape_one_at_a_time(boost::string_ref const content)
+	{
+		std::string expected;
+		for (char const c : content)
+		{
+			switch (c)
+			{
+			case '&':
+				expected += "&amp;";
+				break;
+			case '<':
+				expected += "&lt;";
+				break;
+			case '>':
+				expected += "&gt;";
+				break;
+			case '"':
+				expected += "&quot;";
+				break;
+			case '\'':
+				expected += "&apos;";
+				break;
+			default:
+				expected += c;
+				break;
+			}
+		}
+		return expected;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(escape_nothing)
+{
+	BOOST_CHECK_EQUAL("", escape(""));
+	BOOST_CHECK_EQUAL("abc", escape("abc"));
+}
+
+BOOST_AUTO_TEST_CASE(escape_all_special_characters)
+{
+	BOOST_CHECK_EQUAL("&amp;&lt;&gt;&quot;&apos;", escape("&<>\"'"));
+	BOOST_CHECK_EQUAL("a &lt;b&gt; c", escape("a <b> c"));
+}
+
+BOOST_AUTO_TEST_CASE(escape_at_every_position)
+{
+	// covers the vectorized loops, their boundaries and the scalar rest
+	for (std::size_t length = 1; length <= 100; ++length)
+	{
+		for (std::size_t position = 0; position < length; ++position)
+		{
+			std::string content(length, 'x');
+			content[position] = "&<>\"'"[position % 5];
+			BOOST_REQUIRE_EQUAL(escape_one_at_a_time(content),
+			                    escape(content));
+			BOOST_REQUIRE(content.data() + position ==
+			              find_character_to_escape(
+			                  content.data(), content.data() + content.size()));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(escape_characters_with_the_high_bit_set)
+{
+	std::string const content = "\xc3\xa4\xff\x80<\xfe";
+	BOOST_CHECK_EQUAL("\xc3\xa4\xff\x80&lt;\xfe", escape(content));
+}
@@ -0,0 +1,51 @@
+#include "html_generator/server/validators.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(etag_is_quoted_hash)
+{
+	std::string const etag = make_strong_etag("content");
+	BOOST_CHECK_EQUAL(18u, etag.size());
+	BOOST_CHECK_EQUAL('"', etag.front());
+	BOOST_CHECK_EQUAL('"', etag.back());
+	BOOST_CHECK_EQUAL(etag, make_strong_etag("content"));
+	BOOST_CHECK_NE(etag, make_strong_etag("Content"));
+	BOOST_CHECK_EQUAL("\"cbf29ce484222325\"", make_strong_etag(""));
+}
+
+BOOST_AUTO_TEST_CASE(if_none_match)
+{
+	BOOST_CHECK(if_none_match_matches("\"abc\"", "\"abc\""));
+	BOOST_CHECK(if_none_match_matches("\"x\", \"abc\"", "\"abc\""));
+	BOOST_CHECK(if_none_match_matches("W/\"abc\"", "\"abc\""));
+	BOOST_CHECK(if_none_match_matches("*", "\"abc\""));
+	BOOST_CHECK(!if_none_match_matches("\"abcd\"", "\"abc\""));
+	BOOST_CHECK(!if_none_match_matches("", "\"abc\""));
+}
+
+BOOST_AUTO_TEST_CASE(format_http_date_epoch)
+{
+	BOOST_CHECK_EQUAL("Thu, 01 Jan 1970 00:00:00 GMT", format_http_date(0));
+}
+
+BOOST_AUTO_TEST_CASE(format_http_date_rfc_example)
+{
+	BOOST_CHECK_EQUAL("Sun, 06 Nov 1994 08:49:37 GMT",
+	                  format_http_date(784111777));
+}
+
+BOOST_AUTO_TEST_CASE(parse_http_date_round_trip)
+{
+	Si::optional<std::time_t> const parsed =
+	    parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT");
+	BOOST_REQUIRE(parsed);
+	BOOST_CHECK_EQUAL(784111777, *parsed);
+}
+
+BOOST_AUTO_TEST_CASE(parse_http_date_invalid)
+{
+	BOOST_CHECK(!parse_http_date(""));
+	BOOST_CHECK(!parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT"));
+	BOOST_CHECK(!parse_http_date("Sun, 06 Foo 1994 08:49:37 GMT"));
+	BOOST_CHECK(!parse_http_date("Sun, 31 Feb 1994 08:49:37 GMT"));
+	BOOST_CHECK(!parse_http_date("Sun, 06 Nov 1994 08:49:37 UTC"));
+}